@@ -26,6 +26,7 @@
 #include <QtCrypto>
 #include "xmpp_jid.h"
 #include "jinglertp.h"
+#include "avtransmit.h"
 #include "../psimedia/psimedia.h"
 #include "applicationinfo.h"
 #include "psiaccount.h"
@@ -171,98 +172,6 @@ static PsiMedia::PayloadInfo payloadTypeToPayloadInfo(const JingleRtpPayloadType
 	return out;
 }
 
-class AvTransmit : public QObject
-{
-	Q_OBJECT
-
-public:
-	PsiMedia::RtpChannel *audio, *video;
-	JingleRtpChannel *transport;
-
-	AvTransmit(PsiMedia::RtpChannel *_audio, PsiMedia::RtpChannel *_video, JingleRtpChannel *_transport, QObject *parent = 0) :
-		QObject(parent),
-		audio(_audio),
-		video(_video),
-		transport(_transport)
-	{
-		if(audio)
-		{
-			audio->setParent(this);
-			connect(audio, SIGNAL(readyRead()), SLOT(audio_readyRead()));
-		}
-
-		if(video)
-		{
-			video->setParent(this);
-			connect(video, SIGNAL(readyRead()), SLOT(video_readyRead()));
-		}
-
-		transport->setParent(this);
-		connect(transport, SIGNAL(readyRead()), SLOT(transport_readyRead()));
-		connect(transport, SIGNAL(packetsWritten(int)), SLOT(transport_packetsWritten(int)));
-	}
-
-	~AvTransmit()
-	{
-		if(audio)
-			audio->setParent(0);
-		if(video)
-			video->setParent(0);
-		transport->setParent(0);
-	}
-
-private slots:
-	void audio_readyRead()
-	{
-		while(audio->packetsAvailable() > 0)
-		{
-			PsiMedia::RtpPacket packet = audio->read();
-
-			JingleRtp::RtpPacket jpacket;
-			jpacket.type = JingleRtp::Audio;
-			jpacket.portOffset = packet.portOffset();
-			jpacket.value = packet.rawValue();
-
-			transport->write(jpacket);
-		}
-	}
-
-	void video_readyRead()
-	{
-		while(video->packetsAvailable() > 0)
-		{
-			PsiMedia::RtpPacket packet = video->read();
-
-			JingleRtp::RtpPacket jpacket;
-			jpacket.type = JingleRtp::Video;
-			jpacket.portOffset = packet.portOffset();
-			jpacket.value = packet.rawValue();
-
-			transport->write(jpacket);
-		}
-	}
-
-	void transport_readyRead()
-	{
-		while(transport->packetsAvailable())
-		{
-			JingleRtp::RtpPacket jpacket = transport->read();
-
-			if(jpacket.type == JingleRtp::Audio)
-				audio->write(PsiMedia::RtpPacket(jpacket.value, jpacket.portOffset));
-			else if(jpacket.type == JingleRtp::Video)
-				video->write(PsiMedia::RtpPacket(jpacket.value, jpacket.portOffset));
-		}
-	}
-
-	void transport_packetsWritten(int count)
-	{
-		Q_UNUSED(count);
-
-		// nothing
-	}
-};
-
 class AvTransmitHandler : public QObject
 {
 	Q_OBJECT
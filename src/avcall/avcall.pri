@@ -3,12 +3,14 @@ QT *= network
 HEADERS += \
 	$$PWD/jinglertptasks.h \
 	$$PWD/jinglertp.h \
+	$$PWD/avtransmit.h \
 	$$PWD/avcall.h \
 	$$PWD/calldlg.h
 
 SOURCES += \
 	$$PWD/jinglertptasks.cpp \
 	$$PWD/jinglertp.cpp \
+	$$PWD/avtransmit.cpp \
 	$$PWD/avcall.cpp \
 	$$PWD/calldlg.cpp
 
@@ -0,0 +1,104 @@
+/*
+ * Copyright (C) 2009  Barracuda Networks, Inc.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "avtransmit.h"
+
+#include "jinglertp.h"
+#include "../psimedia/psimedia.h"
+
+AvTransmit::AvTransmit(PsiMedia::RtpChannel *_audio, PsiMedia::RtpChannel *_video, JingleRtpChannel *_transport, QObject *parent) :
+	QObject(parent),
+	audio(_audio),
+	video(_video),
+	transport(_transport)
+{
+	if(audio)
+	{
+		audio->setParent(this);
+		connect(audio, SIGNAL(readyRead()), SLOT(audio_readyRead()));
+	}
+
+	if(video)
+	{
+		video->setParent(this);
+		connect(video, SIGNAL(readyRead()), SLOT(video_readyRead()));
+	}
+
+	transport->setParent(this);
+	connect(transport, SIGNAL(readyRead()), SLOT(transport_readyRead()));
+	connect(transport, SIGNAL(packetsWritten(int)), SLOT(transport_packetsWritten(int)));
+}
+
+AvTransmit::~AvTransmit()
+{
+	if(audio)
+		audio->setParent(0);
+	if(video)
+		video->setParent(0);
+	transport->setParent(0);
+}
+
+void AvTransmit::audio_readyRead()
+{
+	while(audio->packetsAvailable() > 0)
+	{
+		PsiMedia::RtpPacket packet = audio->read();
+
+		JingleRtp::RtpPacket jpacket;
+		jpacket.type = JingleRtp::Audio;
+		jpacket.portOffset = packet.portOffset();
+		jpacket.value = packet.rawValue();
+
+		transport->write(jpacket);
+	}
+}
+
+void AvTransmit::video_readyRead()
+{
+	while(video->packetsAvailable() > 0)
+	{
+		PsiMedia::RtpPacket packet = video->read();
+
+		JingleRtp::RtpPacket jpacket;
+		jpacket.type = JingleRtp::Video;
+		jpacket.portOffset = packet.portOffset();
+		jpacket.value = packet.rawValue();
+
+		transport->write(jpacket);
+	}
+}
+
+void AvTransmit::transport_readyRead()
+{
+	while(transport->packetsAvailable())
+	{
+		JingleRtp::RtpPacket jpacket = transport->read();
+
+		if(jpacket.type == JingleRtp::Audio)
+			audio->write(PsiMedia::RtpPacket(jpacket.value, jpacket.portOffset));
+		else if(jpacket.type == JingleRtp::Video)
+			video->write(PsiMedia::RtpPacket(jpacket.value, jpacket.portOffset));
+	}
+}
+
+void AvTransmit::transport_packetsWritten(int count)
+{
+	Q_UNUSED(count);
+
+	// nothing
+}
@@ -0,0 +1,52 @@
+/*
+ * Copyright (C) 2009  Barracuda Networks, Inc.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef AVTRANSMIT_H
+#define AVTRANSMIT_H
+
+#include <QObject>
+
+namespace PsiMedia
+{
+	class RtpChannel;
+}
+
+class JingleRtpChannel;
+
+// shuttles RTP packets between the media engine and the jingle transport.
+//   it takes parentship of the channels for its lifetime, so that it can
+//   be moved to a dedicated thread along with them.
+class AvTransmit : public QObject
+{
+	Q_OBJECT
+
+public:
+	PsiMedia::RtpChannel *audio, *video;
+	JingleRtpChannel *transport;
+
+	AvTransmit(PsiMedia::RtpChannel *_audio, PsiMedia::RtpChannel *_video, JingleRtpChannel *_transport, QObject *parent = 0);
+	~AvTransmit();
+
+private slots:
+	void audio_readyRead();
+	void video_readyRead();
+	void transport_readyRead();
+	void transport_packetsWritten(int count);
+};
+
+#endif
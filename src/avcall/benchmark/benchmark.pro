@@ -0,0 +1,32 @@
+TEMPLATE = app
+TARGET = rtpbenchmark
+CONFIG += console crypto
+CONFIG -= app_bundle
+QT -= gui
+QT += network xml
+
+DEFINES += QT_STATICPLUGIN
+
+# iris for ice and jingle tasks
+include(../../../iris/iris.pri)
+
+include(../../psimedia/psimedia.pri)
+INCLUDEPATH += ../../psimedia ..
+
+HEADERS += \
+	../jinglertptasks.h \
+	../jinglertp.h \
+	../avtransmit.h \
+	fakeprovider.h
+
+SOURCES += \
+	../jinglertptasks.cpp \
+	../jinglertp.cpp \
+	../avtransmit.cpp \
+	fakeprovider.cpp \
+	rtpbenchmark.cpp
+
+# run target
+QMAKE_EXTRA_TARGETS += run
+run.depends = $$TARGET
+run.commands = ./$$TARGET
@@ -0,0 +1,407 @@
+/*
+ * fakeprovider.cpp - synthetic PsiMedia provider for benchmarking
+ * Copyright (C) 2026  Psi Team
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#include "fakeprovider.h"
+
+#include <QElapsedTimer>
+#include <QTimer>
+#include <QtPlugin>
+
+namespace FakeMedia {
+
+// RTP fixed header, followed by the 8-byte send timestamp
+static const int RTP_HEADER_SIZE = 12;
+static const int STAMP_SIZE = 8;
+
+// the generator wakes up this often and sends whatever is due
+static const int TICK_INTERVAL = 5;
+
+static Settings g_settings;
+static Stats g_stats;
+
+Stats::Stats()
+{
+	reset();
+}
+
+void Stats::reset()
+{
+	packetsSent = 0;
+	packetsReceived = 0;
+	bytesReceived = 0;
+	packetsMalformed = 0;
+	latencies.clear();
+}
+
+void setSettings(const Settings &settings)
+{
+	g_settings = settings;
+}
+
+Settings settings()
+{
+	return g_settings;
+}
+
+Stats *stats()
+{
+	return &g_stats;
+}
+
+qint64 now()
+{
+	static QElapsedTimer timer;
+	if (!timer.isValid())
+		timer.start();
+	return timer.nsecsElapsed();
+}
+
+static void putBigEndian(char *p, quint64 value, int bytes)
+{
+	for (int i = bytes - 1; i >= 0; --i) {
+		p[i] = char(value & 0xff);
+		value >>= 8;
+	}
+}
+
+static quint64 getBigEndian(const char *p, int bytes)
+{
+	quint64 value = 0;
+	for (int i = 0; i < bytes; ++i)
+		value = (value << 8) | quint8(p[i]);
+	return value;
+}
+
+//----------------------------------------------------------------------------
+// RtpChannel
+//----------------------------------------------------------------------------
+class RtpChannel : public QObject, public PsiMedia::RtpChannelContext
+{
+	Q_OBJECT
+	Q_INTERFACES(PsiMedia::RtpChannelContext)
+
+public:
+	RtpChannel(int payloadType, QObject *parent)
+		: QObject(parent)
+		, payloadType_(payloadType)
+		, enabled_(false)
+		, transmitting_(false)
+		, sequence_(0)
+		, ssrc_(qrand())
+		, startTime_(0)
+		, generated_(0)
+	{
+		timer_ = new QTimer(this);
+		timer_->setInterval(TICK_INTERVAL);
+		connect(timer_, SIGNAL(timeout()), SLOT(generate()));
+	}
+
+	void setTransmitting(bool transmitting)
+	{
+		transmitting_ = transmitting;
+		startTime_ = now();
+		generated_ = 0;
+		updateTimer();
+	}
+
+	// PsiMedia::RtpChannelContext
+	virtual QObject *qobject()
+	{
+		return this;
+	}
+
+	virtual void setEnabled(bool b)
+	{
+		enabled_ = b;
+		updateTimer();
+	}
+
+	virtual int packetsAvailable() const
+	{
+		return out_.count();
+	}
+
+	virtual PsiMedia::PRtpPacket read()
+	{
+		return out_.takeFirst();
+	}
+
+	virtual void write(const PsiMedia::PRtpPacket &rtp)
+	{
+		if (rtp.portOffset != 0)
+			return;
+
+		Stats *s = stats();
+		const QByteArray &data = rtp.rawValue;
+		if (data.size() < RTP_HEADER_SIZE + STAMP_SIZE) {
+			++s->packetsMalformed;
+			return;
+		}
+
+		qint64 sent = qint64(getBigEndian(data.constData() + RTP_HEADER_SIZE, STAMP_SIZE));
+		++s->packetsReceived;
+		s->bytesReceived += data.size();
+		s->latencies += now() - sent;
+	}
+
+signals:
+	void readyRead();
+	void packetsWritten(int count);
+
+private slots:
+	void generate()
+	{
+		Settings s = settings();
+		int packetSize = qMax(s.packetSize, RTP_HEADER_SIZE + STAMP_SIZE);
+
+		// how many packets should have been sent by now at this bitrate
+		qint64 elapsed = now() - startTime_;
+		qint64 due = (elapsed * s.kbps * 1000 / 8) / (qint64(packetSize) * 1000000000);
+		int count = int(due - generated_);
+		if (count <= 0)
+			return;
+
+		for (int n = 0; n < count; ++n)
+			out_ += createPacket(packetSize);
+		generated_ += count;
+		stats()->packetsSent += count;
+
+		emit readyRead();
+	}
+
+private:
+	PsiMedia::PRtpPacket createPacket(int packetSize)
+	{
+		QByteArray data(packetSize, 0);
+		char *p = data.data();
+		p[0] = char(0x80); // version 2
+		p[1] = char(payloadType_ & 0x7f);
+		putBigEndian(p + 2, sequence_++, 2);
+		putBigEndian(p + 4, quint32(now() / 1000000), 4);
+		putBigEndian(p + 8, ssrc_, 4);
+		putBigEndian(p + RTP_HEADER_SIZE, quint64(now()), STAMP_SIZE);
+
+		PsiMedia::PRtpPacket packet;
+		packet.rawValue = data;
+		packet.portOffset = 0;
+		return packet;
+	}
+
+	void updateTimer()
+	{
+		if (enabled_ && transmitting_)
+			timer_->start();
+		else
+			timer_->stop();
+	}
+
+	int payloadType_;
+	bool enabled_;
+	bool transmitting_;
+	quint16 sequence_;
+	quint32 ssrc_;
+	qint64 startTime_;
+	qint64 generated_;
+	QTimer *timer_;
+	QList<PsiMedia::PRtpPacket> out_;
+};
+
+//----------------------------------------------------------------------------
+// RtpSession
+//----------------------------------------------------------------------------
+class RtpSession : public QObject, public PsiMedia::RtpSessionContext
+{
+	Q_OBJECT
+	Q_INTERFACES(PsiMedia::RtpSessionContext)
+
+public:
+	RtpSession(QObject *parent = 0)
+		: QObject(parent)
+		, outputVolume_(100)
+		, inputVolume_(100)
+	{
+		// parentship is taken over by PsiMedia::RtpChannel once started
+		audio_ = new RtpChannel(0, this);
+		video_ = new RtpChannel(96, this);
+	}
+
+	// PsiMedia::RtpSessionContext
+	virtual QObject *qobject() { return this; }
+
+	virtual void setAudioOutputDevice(const QString &) {}
+	virtual void setAudioInputDevice(const QString &) {}
+	virtual void setVideoInputDevice(const QString &) {}
+	virtual void setFileInput(const QString &) {}
+	virtual void setFileDataInput(const QByteArray &) {}
+	virtual void setFileLoopEnabled(bool) {}
+
+#ifdef QT_GUI_LIB
+	virtual void setVideoOutputWidget(PsiMedia::VideoWidgetContext *) {}
+	virtual void setVideoPreviewWidget(PsiMedia::VideoWidgetContext *) {}
+#endif
+
+	virtual void setRecorder(QIODevice *) {}
+	virtual void stopRecording() {}
+
+	virtual void setLocalAudioPreferences(const QList<PsiMedia::PAudioParams> &) {}
+	virtual void setLocalVideoPreferences(const QList<PsiMedia::PVideoParams> &) {}
+	virtual void setMaximumSendingBitrate(int) {}
+	virtual void setRemoteAudioPreferences(const QList<PsiMedia::PPayloadInfo> &) {}
+	virtual void setRemoteVideoPreferences(const QList<PsiMedia::PPayloadInfo> &) {}
+
+	virtual void start()
+	{
+		QMetaObject::invokeMethod(this, "started", Qt::QueuedConnection);
+	}
+
+	virtual void updatePreferences()
+	{
+		QMetaObject::invokeMethod(this, "preferencesUpdated", Qt::QueuedConnection);
+	}
+
+	virtual void transmitAudio() { audio_->setTransmitting(true); }
+	virtual void transmitVideo() { video_->setTransmitting(true); }
+	virtual void pauseAudio() { audio_->setTransmitting(false); }
+	virtual void pauseVideo() { video_->setTransmitting(false); }
+
+	virtual void stop()
+	{
+		audio_->setTransmitting(false);
+		video_->setTransmitting(false);
+		QMetaObject::invokeMethod(this, "stopped", Qt::QueuedConnection);
+	}
+
+	virtual QList<PsiMedia::PPayloadInfo> localAudioPayloadInfo() const { return payloadInfo(0, "PCMU", 8000); }
+	virtual QList<PsiMedia::PPayloadInfo> localVideoPayloadInfo() const { return payloadInfo(96, "THEORA", 90000); }
+	virtual QList<PsiMedia::PPayloadInfo> remoteAudioPayloadInfo() const { return localAudioPayloadInfo(); }
+	virtual QList<PsiMedia::PPayloadInfo> remoteVideoPayloadInfo() const { return localVideoPayloadInfo(); }
+
+	virtual QList<PsiMedia::PAudioParams> audioParams() const { return QList<PsiMedia::PAudioParams>(); }
+	virtual QList<PsiMedia::PVideoParams> videoParams() const { return QList<PsiMedia::PVideoParams>(); }
+
+	virtual bool canTransmitAudio() const { return true; }
+	virtual bool canTransmitVideo() const { return true; }
+
+	virtual int outputVolume() const { return outputVolume_; }
+	virtual void setOutputVolume(int level) { outputVolume_ = level; }
+	virtual int inputVolume() const { return inputVolume_; }
+	virtual void setInputVolume(int level) { inputVolume_ = level; }
+
+	virtual Error errorCode() const { return ErrorGeneric; }
+
+	virtual PsiMedia::RtpChannelContext *audioRtpChannel() { return audio_; }
+	virtual PsiMedia::RtpChannelContext *videoRtpChannel() { return video_; }
+
+signals:
+	void started();
+	void preferencesUpdated();
+	void audioOutputIntensityChanged(int intensity);
+	void audioInputIntensityChanged(int intensity);
+	void stoppedRecording();
+	void stopped();
+	void finished();
+	void error();
+
+private:
+	static QList<PsiMedia::PPayloadInfo> payloadInfo(int id, const QString &name, int clockrate)
+	{
+		PsiMedia::PPayloadInfo pi;
+		pi.id = id;
+		pi.name = name;
+		pi.clockrate = clockrate;
+		pi.channels = 1;
+		return QList<PsiMedia::PPayloadInfo>() << pi;
+	}
+
+	RtpChannel *audio_;
+	RtpChannel *video_;
+	int outputVolume_;
+	int inputVolume_;
+};
+
+//----------------------------------------------------------------------------
+// Features
+//----------------------------------------------------------------------------
+class Features : public QObject, public PsiMedia::FeaturesContext
+{
+	Q_OBJECT
+	Q_INTERFACES(PsiMedia::FeaturesContext)
+
+public:
+	virtual QObject *qobject() { return this; }
+
+	virtual void lookup(int types)
+	{
+		Q_UNUSED(types);
+		QMetaObject::invokeMethod(this, "finished", Qt::QueuedConnection);
+	}
+
+	virtual bool waitForFinished(int msecs)
+	{
+		Q_UNUSED(msecs);
+		return true;
+	}
+
+	virtual PsiMedia::PFeatures results() const
+	{
+		return PsiMedia::PFeatures();
+	}
+
+signals:
+	void finished();
+};
+
+//----------------------------------------------------------------------------
+// Provider
+//----------------------------------------------------------------------------
+class Provider : public QObject, public PsiMedia::Provider
+{
+	Q_OBJECT
+	Q_INTERFACES(PsiMedia::Provider)
+
+public:
+	virtual QObject *qobject() { return this; }
+
+	virtual bool init(const QString &resourcePath)
+	{
+		Q_UNUSED(resourcePath);
+		now(); // start the clock
+		return true;
+	}
+
+	virtual QString creditName() { return "Fake Media"; }
+	virtual QString creditText() { return "Synthetic RTP generator for benchmarking."; }
+
+	virtual PsiMedia::FeaturesContext *createFeatures() { return new Features; }
+	virtual PsiMedia::RtpSessionContext *createRtpSession() { return new RtpSession; }
+};
+
+PsiMedia::Provider *Plugin::createProvider()
+{
+	return new Provider;
+}
+
+}
+
+#ifndef HAVE_QT5
+Q_EXPORT_PLUGIN2(fakemediaprovider, FakeMedia::Plugin);
+#endif
+
+#include "fakeprovider.moc"
@@ -0,0 +1,91 @@
+/*
+ * fakeprovider.h - synthetic PsiMedia provider for benchmarking
+ * Copyright (C) 2026  Psi Team
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#ifndef FAKEPROVIDER_H
+#define FAKEPROVIDER_H
+
+#ifndef QT_STATICPLUGIN
+#define QT_STATICPLUGIN
+#endif
+
+#include <QObject>
+#include <QVector>
+
+#include "psimediaprovider.h"
+
+namespace FakeMedia {
+
+/**
+ * \brief Generator settings shared by every session of the provider.
+ */
+class Settings
+{
+public:
+	int kbps;
+	int packetSize; // whole RTP packet, header included
+
+	Settings()
+		: kbps(64)
+		, packetSize(172)
+	{
+	}
+};
+
+/**
+ * \brief What the provider observed on both ends of the media path.
+ *
+ * Every generated packet carries its send time, so the receiving
+ * channel can compute the one-way latency through the bridge.
+ */
+class Stats
+{
+public:
+	qint64 packetsSent;
+	qint64 packetsReceived;
+	qint64 bytesReceived;
+	qint64 packetsMalformed;
+	QVector<qint64> latencies; // in nanoseconds
+
+	Stats();
+	void reset();
+};
+
+void setSettings(const Settings &settings);
+Settings settings();
+Stats *stats();
+
+// nanoseconds on a monotonic clock
+qint64 now();
+
+class Plugin : public QObject, public PsiMedia::Plugin
+{
+	Q_OBJECT
+#ifdef HAVE_QT5
+	Q_PLUGIN_METADATA(IID "org.psi-im.psimedia.Plugin/1.0")
+#endif
+	Q_INTERFACES(PsiMedia::Plugin)
+
+public:
+	virtual PsiMedia::Provider *createProvider();
+};
+
+}
+
+#endif
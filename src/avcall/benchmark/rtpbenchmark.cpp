@@ -0,0 +1,304 @@
+/*
+ * rtpbenchmark.cpp - loopback benchmark of the call media path
+ * Copyright (C) 2026  Psi Team
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+// Runs synthetic RTP from FakeMedia::Provider through AvTransmit and a
+// pair of JingleRtpChannels connected over ICE on 127.0.0.1, and prints
+// one "name value" pair per line so results can be diffed across builds.
+//
+// usage: rtpbenchmark [--kbps N] [--packet-size N] [--duration SEC]
+//                     [--warmup MSEC] [--video]
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <QCoreApplication>
+#include <QStringList>
+#include <QTimer>
+#include <QtAlgorithms>
+#include <QtCrypto>
+#include <QtPlugin>
+
+#ifdef Q_OS_UNIX
+#include <sys/resource.h>
+#endif
+
+#include "psimedia.h"
+#include "jinglertp.h"
+#include "avtransmit.h"
+#include "fakeprovider.h"
+
+#ifdef HAVE_QT5
+Q_IMPORT_PLUGIN(Plugin)
+#else
+Q_IMPORT_PLUGIN(fakemediaprovider)
+#endif
+
+// count heap allocations by interposing malloc.  only possible with glibc,
+// elsewhere allocations are reported as -1.
+#if defined(Q_OS_LINUX) && defined(__GLIBC__)
+#define HAVE_ALLOC_COUNTER
+
+static QAtomicInt g_allocations;
+
+extern "C" {
+extern void *__libc_malloc(size_t size);
+extern void *__libc_calloc(size_t nmemb, size_t size);
+extern void *__libc_realloc(void *ptr, size_t size);
+
+void *malloc(size_t size)
+{
+	g_allocations.ref();
+	return __libc_malloc(size);
+}
+
+void *calloc(size_t nmemb, size_t size)
+{
+	g_allocations.ref();
+	return __libc_calloc(nmemb, size);
+}
+
+void *realloc(void *ptr, size_t size)
+{
+	g_allocations.ref();
+	return __libc_realloc(ptr, size);
+}
+}
+
+static qint64 allocations()
+{
+	return g_allocations.fetchAndAddRelaxed(0);
+}
+#else
+static qint64 allocations()
+{
+	return -1;
+}
+#endif
+
+// user + system time in microseconds
+static qint64 cpuTime()
+{
+#ifdef Q_OS_UNIX
+	struct rusage ru;
+	if (getrusage(RUSAGE_SELF, &ru) != 0)
+		return -1;
+	return qint64(ru.ru_utime.tv_sec + ru.ru_stime.tv_sec) * 1000000
+	     + ru.ru_utime.tv_usec + ru.ru_stime.tv_usec;
+#else
+	return -1;
+#endif
+}
+
+static qint64 percentile(const QVector<qint64> &sorted, double p)
+{
+	if (sorted.isEmpty())
+		return 0;
+	int index = qBound(0, int(p * (sorted.count() - 1) + 0.5), sorted.count() - 1);
+	return sorted[index];
+}
+
+class RtpBenchmark : public QObject
+{
+	Q_OBJECT
+
+public:
+	int duration;
+	int warmup;
+	bool video;
+
+	RtpBenchmark(QObject *parent = 0)
+		: QObject(parent)
+		, duration(10)
+		, warmup(500)
+		, video(false)
+		, loopback_(0)
+		, sender_(0)
+		, receiver_(0)
+		, senderTransmit_(0)
+		, receiverTransmit_(0)
+		, sessionsStarted_(0)
+		, startCpu_(0)
+		, startAllocations_(0)
+		, startTime_(0)
+	{
+	}
+
+	~RtpBenchmark()
+	{
+		delete senderTransmit_;
+		delete receiverTransmit_;
+		delete sender_;
+		delete receiver_;
+		delete loopback_;
+	}
+
+public slots:
+	void start()
+	{
+		loopback_ = new JingleRtpLoopback(this);
+		connect(loopback_, SIGNAL(activated()), SLOT(loopback_activated()));
+		connect(loopback_, SIGNAL(error()), SLOT(loopback_error()));
+		loopback_->start(video ? JingleRtp::Video : JingleRtp::Audio);
+	}
+
+private slots:
+	void loopback_activated()
+	{
+		sender_ = new PsiMedia::RtpSession;
+		receiver_ = new PsiMedia::RtpSession;
+		connect(sender_, SIGNAL(started()), SLOT(session_started()));
+		connect(receiver_, SIGNAL(started()), SLOT(session_started()));
+		sender_->start();
+		receiver_->start();
+	}
+
+	void loopback_error()
+	{
+		fprintf(stderr, "rtpbenchmark: unable to establish ICE loopback\n");
+		QCoreApplication::exit(1);
+	}
+
+	void session_started()
+	{
+		if (++sessionsStarted_ < 2)
+			return;
+
+		senderTransmit_ = createTransmit(sender_, loopback_->initiatorChannel());
+		receiverTransmit_ = createTransmit(receiver_, loopback_->responderChannel());
+
+		if (video)
+			sender_->transmitVideo();
+		else
+			sender_->transmitAudio();
+
+		QTimer::singleShot(warmup, this, SLOT(warmupFinished()));
+	}
+
+	void warmupFinished()
+	{
+		FakeMedia::stats()->reset();
+		FakeMedia::stats()->latencies.reserve(1 << 20);
+		startCpu_ = cpuTime();
+		startAllocations_ = allocations();
+		startTime_ = FakeMedia::now();
+		QTimer::singleShot(duration * 1000, this, SLOT(finish()));
+	}
+
+	void finish()
+	{
+		qint64 elapsed = FakeMedia::now() - startTime_;
+		qint64 cpu = cpuTime() - startCpu_;
+		qint64 allocs = allocations() - startAllocations_;
+
+		FakeMedia::Stats *s = FakeMedia::stats();
+		FakeMedia::Settings settings = FakeMedia::settings();
+		QVector<qint64> sorted = s->latencies;
+		qSort(sorted);
+
+		double seconds = double(elapsed) / 1e9;
+		printf("rtp.kbps_requested %d\n", settings.kbps);
+		printf("rtp.packet_size %d\n", settings.packetSize);
+		printf("rtp.duration_s %.3f\n", seconds);
+		printf("rtp.packets_sent %lld\n", s->packetsSent);
+		printf("rtp.packets_received %lld\n", s->packetsReceived);
+		printf("rtp.packets_malformed %lld\n", s->packetsMalformed);
+		printf("rtp.throughput_pps %.1f\n", s->packetsReceived / seconds);
+		printf("rtp.throughput_kbps %.1f\n", s->bytesReceived * 8 / seconds / 1000);
+		printf("rtp.latency_p50_us %.1f\n", percentile(sorted, 0.50) / 1000.0);
+		printf("rtp.latency_p90_us %.1f\n", percentile(sorted, 0.90) / 1000.0);
+		printf("rtp.latency_p99_us %.1f\n", percentile(sorted, 0.99) / 1000.0);
+		printf("rtp.latency_max_us %.1f\n", (sorted.isEmpty() ? 0 : sorted.last()) / 1000.0);
+		printf("rtp.cpu_percent %.1f\n", cpu < 0 ? -1.0 : cpu / 1e4 / seconds);
+		if (allocs < 0 || s->packetsReceived == 0)
+			printf("rtp.allocations_per_packet -1\n");
+		else
+			printf("rtp.allocations_per_packet %.2f\n", double(allocs) / s->packetsReceived);
+
+		QCoreApplication::exit(s->packetsReceived > 0 ? 0 : 1);
+	}
+
+private:
+	AvTransmit *createTransmit(PsiMedia::RtpSession *session, JingleRtpChannel *channel)
+	{
+		if (video)
+			return new AvTransmit(0, session->videoRtpChannel(), channel);
+		return new AvTransmit(session->audioRtpChannel(), 0, channel);
+	}
+
+	JingleRtpLoopback *loopback_;
+	PsiMedia::RtpSession *sender_;
+	PsiMedia::RtpSession *receiver_;
+	AvTransmit *senderTransmit_;
+	AvTransmit *receiverTransmit_;
+	int sessionsStarted_;
+	qint64 startCpu_;
+	qint64 startAllocations_;
+	qint64 startTime_;
+};
+
+int main(int argc, char **argv)
+{
+	QCA::Initializer qcaInit;
+	QCoreApplication app(argc, argv);
+
+	FakeMedia::Settings settings;
+	RtpBenchmark bench;
+
+	QStringList args = app.arguments();
+	for (int n = 1; n < args.count(); ++n) {
+		QString arg = args[n];
+		bool needsValue = (arg == "--kbps" || arg == "--packet-size" || arg == "--duration" || arg == "--warmup");
+		if (needsValue && n + 1 >= args.count()) {
+			fprintf(stderr, "rtpbenchmark: %s needs a value\n", qPrintable(arg));
+			return 1;
+		}
+
+		if (arg == "--kbps")
+			settings.kbps = args[++n].toInt();
+		else if (arg == "--packet-size")
+			settings.packetSize = args[++n].toInt();
+		else if (arg == "--duration")
+			bench.duration = args[++n].toInt();
+		else if (arg == "--warmup")
+			bench.warmup = args[++n].toInt();
+		else if (arg == "--video")
+			bench.video = true;
+		else {
+			fprintf(stderr, "usage: rtpbenchmark [--kbps N] [--packet-size N] [--duration SEC] [--warmup MSEC] [--video]\n");
+			return 1;
+		}
+	}
+
+	if (settings.kbps <= 0 || settings.packetSize <= 0 || bench.duration <= 0) {
+		fprintf(stderr, "rtpbenchmark: invalid settings\n");
+		return 1;
+	}
+	FakeMedia::setSettings(settings);
+
+	if (!PsiMedia::isSupported()) {
+		fprintf(stderr, "rtpbenchmark: fake media provider failed to load\n");
+		return 1;
+	}
+
+	QTimer::singleShot(0, &bench, SLOT(start()));
+	return app.exec();
+}
+
+#include "rtpbenchmark.moc"
@@ -1896,4 +1896,231 @@ void JingleRtpManager::setBasePort(int port)
 	d->basePort = port;
 }
 
+//----------------------------------------------------------------------------
+// JingleRtpLoopback
+//----------------------------------------------------------------------------
+class JingleRtpLoopbackPrivate : public QObject
+{
+	Q_OBJECT
+
+public:
+	JingleRtpLoopback *q;
+
+	int types;
+	JingleRtpChannel *channel[2];
+
+	// index 0 is the initiator, index 1 the responder
+	XMPP::Ice176 *iceA[2];
+	XMPP::Ice176 *iceV[2];
+	QList<XMPP::Ice176::Candidate> pendingCandidates[4];
+	int iceCount;
+	int startedCount;
+	int componentsLeft;
+
+	JingleRtpLoopbackPrivate(JingleRtpLoopback *_q) :
+		QObject(_q),
+		q(_q),
+		types(0),
+		iceCount(0),
+		startedCount(0),
+		componentsLeft(0)
+	{
+		for(int n = 0; n < 2; ++n)
+		{
+			channel[n] = new JingleRtpChannel;
+			iceA[n] = 0;
+			iceV[n] = 0;
+		}
+	}
+
+	~JingleRtpLoopbackPrivate()
+	{
+		// the channels only use the ice objects, they take ownership
+		//   just when given a port reserver, which we don't have
+		for(int n = 0; n < 2; ++n)
+		{
+			delete channel[n];
+			delete iceA[n];
+			delete iceV[n];
+		}
+	}
+
+	void start(int _types)
+	{
+		types = _types;
+
+		QList<XMPP::Ice176::LocalAddress> localAddrs;
+		XMPP::Ice176::LocalAddress addr;
+		addr.addr = QHostAddress(QHostAddress::LocalHost);
+		localAddrs += addr;
+
+		for(int n = 0; n < 2; ++n)
+		{
+			if(types & JingleRtp::Audio)
+				iceA[n] = createIce(localAddrs);
+			if(types & JingleRtp::Video)
+				iceV[n] = createIce(localAddrs);
+		}
+
+		// RTP+RTCP on both ends of each session
+		componentsLeft = iceCount * 2;
+
+		for(int n = 0; n < 2; ++n)
+		{
+			XMPP::Ice176::Mode m = (n == 0 ? XMPP::Ice176::Initiator : XMPP::Ice176::Responder);
+			if(iceA[n])
+				iceA[n]->start(m);
+			if(iceV[n])
+				iceV[n]->start(m);
+		}
+	}
+
+private:
+	XMPP::Ice176 *createIce(const QList<XMPP::Ice176::LocalAddress> &localAddrs)
+	{
+		XMPP::Ice176 *ice = new XMPP::Ice176(this);
+		connect(ice, SIGNAL(started()), SLOT(ice_started()));
+		connect(ice, SIGNAL(error(XMPP::Ice176::Error)), SLOT(ice_error(XMPP::Ice176::Error)));
+		connect(ice, SIGNAL(localCandidatesReady(const QList<XMPP::Ice176::Candidate> &)), SLOT(ice_localCandidatesReady(const QList<XMPP::Ice176::Candidate> &)));
+		connect(ice, SIGNAL(componentReady(int)), SLOT(ice_componentReady(int)), Qt::QueuedConnection); // signal is not DOR-SS
+		ice->setLocalAddresses(localAddrs);
+		ice->setComponentCount(2);
+		ice->setLocalCandidateTrickle(true);
+		++iceCount;
+		return ice;
+	}
+
+	// index into pendingCandidates, or -1
+	int indexOf(XMPP::Ice176 *ice) const
+	{
+		for(int n = 0; n < 2; ++n)
+		{
+			if(ice == iceA[n])
+				return n;
+			if(ice == iceV[n])
+				return 2 + n;
+		}
+		return -1;
+	}
+
+	XMPP::Ice176 *peerOf(XMPP::Ice176 *ice) const
+	{
+		if(ice == iceA[0])
+			return iceA[1];
+		if(ice == iceA[1])
+			return iceA[0];
+		if(ice == iceV[0])
+			return iceV[1];
+		return iceV[0];
+	}
+
+	bool allStarted() const
+	{
+		return startedCount == iceCount;
+	}
+
+private slots:
+	void ice_started()
+	{
+		XMPP::Ice176 *ice = (XMPP::Ice176 *)sender();
+		if(ice == iceA[0] || ice == iceA[1])
+		{
+			ice->flagComponentAsLowOverhead(0);
+			ice->flagComponentAsLowOverhead(1);
+		}
+		else
+			ice->flagComponentAsLowOverhead(1);
+
+		++startedCount;
+		if(!allStarted())
+			return;
+
+		// credentials are only known once every session has started,
+		//   so candidates gathered until now were held back
+		for(int n = 0; n < 2; ++n)
+		{
+			XMPP::Ice176 *list[2] = { iceA[n], iceV[n] };
+			for(int i = 0; i < 2; ++i)
+			{
+				if(!list[i])
+					continue;
+				XMPP::Ice176 *peer = peerOf(list[i]);
+				list[i]->setPeerUfrag(peer->localUfrag());
+				list[i]->setPeerPassword(peer->localPassword());
+			}
+		}
+
+		for(int n = 0; n < 4; ++n)
+		{
+			if(pendingCandidates[n].isEmpty())
+				continue;
+			XMPP::Ice176 *from = (n < 2 ? iceA[n] : iceV[n - 2]);
+			peerOf(from)->addRemoteCandidates(pendingCandidates[n]);
+			pendingCandidates[n].clear();
+		}
+	}
+
+	void ice_error(XMPP::Ice176::Error e)
+	{
+		Q_UNUSED(e);
+
+		emit q->error();
+	}
+
+	void ice_localCandidatesReady(const QList<XMPP::Ice176::Candidate> &list)
+	{
+		XMPP::Ice176 *ice = (XMPP::Ice176 *)sender();
+
+		if(allStarted())
+			peerOf(ice)->addRemoteCandidates(list);
+		else
+			pendingCandidates[indexOf(ice)] += list;
+	}
+
+	void ice_componentReady(int index)
+	{
+		Q_UNUSED(index);
+
+		if(--componentsLeft > 0)
+			return;
+
+		for(int n = 0; n < 2; ++n)
+		{
+			if(iceA[n])
+				iceA[n]->disconnect(this);
+			if(iceV[n])
+				iceV[n]->disconnect(this);
+			channel[n]->d->setIceObjects(0, iceA[n], iceV[n]);
+		}
+
+		emit q->activated();
+	}
+};
+
+JingleRtpLoopback::JingleRtpLoopback(QObject *parent) :
+	QObject(parent)
+{
+	d = new JingleRtpLoopbackPrivate(this);
+}
+
+JingleRtpLoopback::~JingleRtpLoopback()
+{
+	delete d;
+}
+
+void JingleRtpLoopback::start(int types)
+{
+	d->start(types);
+}
+
+JingleRtpChannel *JingleRtpLoopback::initiatorChannel()
+{
+	return d->channel[0];
+}
+
+JingleRtpChannel *JingleRtpLoopback::responderChannel()
+{
+	return d->channel[1];
+}
+
 #include "jinglertp.moc"
@@ -26,6 +26,7 @@ class JingleRtpChannel;
 class JingleRtpPrivate;
 class JingleRtpChannelPrivate;
 class JingleRtpManagerPrivate;
+class JingleRtpLoopbackPrivate;
 
 class JingleRtp : public QObject
 {
@@ -124,6 +125,7 @@ private:
 
 	friend class JingleRtpChannelPrivate;
 	friend class JingleRtpPrivate;
+	friend class JingleRtpLoopbackPrivate;
 	JingleRtpChannel();
 	~JingleRtpChannel();
 
@@ -161,4 +163,34 @@ private:
 	JingleRtpManagerPrivate *d;
 };
 
+// connects two channels to each other over ICE sessions bound to the
+//   loopback interface, with the candidate exchange done in-process
+//   instead of over XMPP.  this is only meant for exercising the media
+//   path without a server (see src/avcall/benchmark).
+class JingleRtpLoopback : public QObject
+{
+	Q_OBJECT
+
+public:
+	JingleRtpLoopback(QObject *parent = 0);
+	~JingleRtpLoopback();
+
+	void start(int types);
+
+	// both channels are valid at construction time, and follow the same
+	//   threading rules as JingleRtp::rtpChannel()
+	JingleRtpChannel *initiatorChannel();
+	JingleRtpChannel *responderChannel();
+
+signals:
+	void error();
+	void activated();
+
+private:
+	Q_DISABLE_COPY(JingleRtpLoopback);
+
+	friend class JingleRtpLoopbackPrivate;
+	JingleRtpLoopbackPrivate *d;
+};
+
 #endif
@@ -73,6 +73,8 @@
 #include "shortcutmanager.h"
 #include "psicontactlist.h"
 #include "accountlabel.h"
+#include "eventdb.h"
+#include "psievent.h"
 #include "psirichtext.h"
 
 #ifdef Q_OS_WIN
@@ -110,6 +112,10 @@ ChatDlg::ChatDlg(const Jid& jid, PsiAccount* pa, TabManager* tabManager)
 	sendComposingEvents_ = false;
 	isComposing_ = false;
 	composingTimer_ = 0;
+
+	historyHandle_ = 0;
+	historyExhausted_ = false;
+	historyAnchorSkip_ = 0;
 }
 
 void ChatDlg::init()
@@ -124,6 +130,8 @@ void ChatDlg::init()
 
 	chatEdit()->installEventFilter(this);
 	connect(chatView(), SIGNAL(selectionChanged()), SLOT(logSelectionChanged()));
+	connect(chatView(), SIGNAL(topReached()), SLOT(loadOlderHistory()));
+	connect(chatView(), SIGNAL(scrollbackTrimmed()), SLOT(scrollbackTrimmed()));
 
 	// SyntaxHighlighters modify the QTextEdit in a QTimer::singleShot(0, ...) call
 	// so we need to install our hooks after it fired for the first time
@@ -148,6 +156,7 @@ void ChatDlg::init()
 
 ChatDlg::~ChatDlg()
 {
+	delete historyHandle_;
 	account()->dialogUnregister(this);
 }
 
@@ -504,6 +513,8 @@ void ChatDlg::setLooks()
 	chatView()->setFont(f);
 	chatEdit()->setFont(f);
 
+	chatView()->setScrollbackLimit(PsiOptions::instance()->getOption("options.ui.chat.scrollback-limit").toInt());
+
 	// update contact info
 	status_ = -2; // sick way of making it redraw the status
 	updateContact(jid(), false);
@@ -567,6 +578,110 @@ void ChatDlg::doFile()
 void ChatDlg::doClear()
 {
 	chatView()->clear();
+	historyExhausted_ = true;
+}
+
+/**
+ * Called when the user scrolled to the top of the chat view. If the view
+ * has dropped old blocks to honour its scrollback limit, fetch the page of
+ * history immediately preceding the oldest message still shown.
+ *
+ * History is paged by EDB id. The first time, the log is walked backwards
+ * from its end past the messages still shown, which are recognized by
+ * their time and the number of them sharing the oldest one; from then on
+ * each page starts right before the previous one.
+ */
+void ChatDlg::loadOlderHistory()
+{
+	if (historyHandle_ || historyExhausted_ || !chatView()->droppedBlocks())
+		return;
+
+	if (historyCursor_.isEmpty()) {
+		historyAnchor_ = chatView()->oldestTimestamp();
+		if (!historyAnchor_.isValid())
+			return;
+		historyAnchorSkip_ = chatView()->oldestTimestampCount();
+	}
+	requestOlderHistory();
+}
+
+void ChatDlg::requestOlderHistory()
+{
+	historyHandle_ = new EDBHandle(account()->edb());
+	connect(historyHandle_, SIGNAL(finished()), SLOT(olderHistoryFinished()));
+	if (historyCursor_.isEmpty())
+		historyHandle_->getLatest(jid(), HISTORYPAGESIZE);
+	else
+		historyHandle_->get(jid(), historyCursor_, EDB::Backward, HISTORYPAGESIZE);
+}
+
+void ChatDlg::olderHistoryFinished()
+{
+	const EDBResult r = historyHandle_->result();
+	// continue past every event the read examined, readable or not
+	historyCursor_ = historyHandle_->nextId();
+	if (historyCursor_.isEmpty())
+		historyExhausted_ = true;
+	historyHandle_->deleteLater();
+	historyHandle_ = 0;
+
+	// events come newest first
+	QList<PsiEvent *> page;
+	foreach(const EDBItemPtr &item, r) {
+		PsiEvent *e = item->event();
+		if (e->type() != PsiEvent::Message)
+			continue;
+		const Message &m = static_cast<MessageEvent *>(e)->message();
+
+		// skip the messages still shown, history keeps whole seconds only
+		if (historyAnchor_.isValid()) {
+			uint time = m.timeStamp().toTime_t();
+			uint anchor = historyAnchor_.toTime_t();
+			if (time > anchor)
+				continue;
+			if (time == anchor && historyAnchorSkip_ > 0) {
+				--historyAnchorSkip_;
+				continue;
+			}
+			historyAnchor_ = QDateTime();
+		}
+		page.prepend(e);
+	}
+
+	if (page.isEmpty()) {
+		// still walking past what is shown or what couldn't be read
+		if (!historyExhausted_)
+			requestOlderHistory();
+		return;
+	}
+
+	historyPageAboutToBeShown();
+	chatView()->beginPrepend();
+	foreach(PsiEvent *e, page) {
+		const Message &m = static_cast<MessageEvent *>(e)->message();
+		bool local = e->originLocal();
+		QString txt = messageText(m);
+		QString subject = messageSubject(m);
+		if (isEmoteMessage(m))
+			appendEmoteMessage(Spooled_None, m.timeStamp(), local, txt, subject);
+		else
+			appendNormalMessage(Spooled_None, m.timeStamp(), local, txt, subject);
+	}
+	chatView()->endPrepend();
+	historyPageShown();
+}
+
+/**
+ * The chat view dropped its oldest messages, so paging has to find its
+ * place in history again.
+ */
+void ChatDlg::scrollbackTrimmed()
+{
+	delete historyHandle_;
+	historyHandle_ = 0;
+	historyCursor_ = QString();
+	historyAnchor_ = QDateTime();
+	historyExhausted_ = false;
 }
 
 void ChatDlg::setKeepOpenFalse()
@@ -1030,6 +1145,16 @@ void ChatDlg::nicksChanged()
 	// this function is intended to be reimplemented in subclasses
 }
 
+void ChatDlg::historyPageAboutToBeShown()
+{
+	// this function is intended to be reimplemented in subclasses
+}
+
+void ChatDlg::historyPageShown()
+{
+	// this function is intended to be reimplemented in subclasses
+}
+
 static const QString me_cmd = "/me ";
 
 bool ChatDlg::isEmoteMessage(const XMPP::Message& m)
@@ -47,6 +47,7 @@ class QDropEvent;
 class QDragEnterEvent;
 class ChatView;
 class ChatEdit;
+class EDBHandle;
 
 class ChatDlg : public TabbableWidget
 {
@@ -133,6 +134,9 @@ private slots:
 	void addEmoticon(QString text);
 	void initComposing();
 	void setComposing();
+	void loadOlderHistory();
+	void olderHistoryFinished();
+	void scrollbackTrimmed();
 
 protected slots:
 	void checkComposing();
@@ -168,6 +172,8 @@ protected:
 	virtual void appendNormalMessage(SpooledType spooled, const QDateTime& time, bool local, const QString& txt, const QString& subject) = 0;
 	virtual void appendMessageFields(const Message& m) = 0;
 	virtual void nicksChanged();
+	virtual void historyPageAboutToBeShown();
+	virtual void historyPageShown();
 
 	QString whoNick(bool local) const;
 
@@ -175,6 +181,8 @@ protected:
 	virtual ChatEdit* chatEdit() const = 0;
 
 private:
+	enum { HISTORYPAGESIZE = 50 };
+
 	bool highlightersInstalled_;
 	QString dispNick_;
 	int status_;
@@ -197,6 +205,14 @@ private:
 	Message m_;
 	bool lastWasEncrypted_;
 
+	// paging of history dropped from the chat view
+	EDBHandle* historyHandle_;
+	bool historyExhausted_;
+	QString historyCursor_;
+	QDateTime historyAnchor_;
+	int historyAnchorSkip_;
+	void requestOlderHistory();
+
 	// Message Events & Chat States
 	QTimer* composingTimer_;
 	bool isComposing_;
@@ -35,7 +35,7 @@ ChatEditProxy::ChatEditProxy(QWidget* parent)
 	layout_->setMargin(0);
 	layout_->setSpacing(0);
 
-	connect(PsiOptions::instance(), SIGNAL(optionChanged(const QString&)), SLOT(optionsChanged()));
+	PsiOptions::instance()->subscribe("options.ui.chat.use-expanding-line-edit", this, SLOT(optionsChanged()));
 	optionsChanged();
 
 	if (!textEdit_)
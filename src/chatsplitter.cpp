@@ -36,7 +36,7 @@ ChatSplitter::ChatSplitter(QWidget* parent)
 	, splitter_(0)
 	, layout_(0)
 {
-	connect(PsiOptions::instance(), SIGNAL(optionChanged(const QString&)), SLOT(optionsChanged()));
+	PsiOptions::instance()->subscribe("options.ui.chat.use-expanding-line-edit", this, SLOT(optionsChanged()));
 	optionsChanged();
 
 	if (!layout_)
@@ -42,9 +42,12 @@ ContactListGroup::ContactListGroup(ContactListModel* model, ContactListGroup* pa
 	, model_(model)
 	, parent_(parent)
 	, updateOnlineContactsTimer_(0)
+	, countedInParent_(false)
 	, haveOnlineContacts_(false)
 	, onlineContactsCount_(0)
 	, totalContactsCount_(0)
+	, notifiedOnlineContactsCount_(0)
+	, notifiedTotalContactsCount_(0)
 {
 	updateOnlineContactsTimer_ = new QTimer(this);
 	connect(updateOnlineContactsTimer_, SIGNAL(timeout()), SLOT(updateOnlineContactsFlag()));
@@ -190,23 +193,50 @@ ContactListItemMenu* ContactListGroup::contextMenu(ContactListModel* model)
 
 void ContactListGroup::addItem(ContactListItemProxy* item)
 {
-	Q_ASSERT(!items_.contains(item));
+	Q_ASSERT(!positions_.contains(item));
 	int index = items_.count();
 	model_->itemAboutToBeInserted(this, index);
 	items_.append(item);
+	positions_.insert(item, index);
+	proxies_.insert(item->item(), item);
 	model_->insertedItem(this, index);
-	updateOnlineContactsTimer_->start();
+
+	// contacts are counted in addContact()
+	if (item->item()->type() != ContactListModel::ContactType) {
+		ContactListGroup* group = dynamic_cast<ContactListGroup*>(item->item());
+		if (group) {
+			group->countedInParent_ = true;
+			adjustContactsCount(group->onlineContactsCount_, group->totalContactsCount_);
+		}
+	}
 }
 
 void ContactListGroup::removeItem(ContactListItemProxy* item)
 {
-	int index = items_.indexOf(item);
-	Q_ASSERT(index != -1);
+	Q_ASSERT(positions_.contains(item));
+	int index = positions_.take(item);
+	if (item->item()) {
+		proxies_.remove(item->item());
+
+		if (item->item()->type() != ContactListModel::ContactType) {
+			ContactListGroup* group = dynamic_cast<ContactListGroup*>(item->item());
+			if (group && group->countedInParent_) {
+				group->countedInParent_ = false;
+				adjustContactsCount(-group->onlineContactsCount_, -group->totalContactsCount_);
+			}
+		}
+	}
+	else {
+		// item was already destroyed, drop the stale key
+		proxies_.remove(proxies_.key(item));
+	}
+
 	model_->itemAboutToBeRemoved(this, index);
 	items_.remove(index);
+	for (int i = index; i < items_.count(); ++i)
+		positions_[items_.at(i)] = i;
 	delete item;
 	model_->removedItem(this, index);
-	updateOnlineContactsTimer_->start();
 }
 
 /**
@@ -227,6 +257,11 @@ CL_DEBUG("ContactListGroup(%x)::addContact: %s (items = %d, contacts = %d)", thi
 	contacts_.append(contact);
 	addItem(new ContactListItemProxy(this, contact));
 
+	bool online = contact->isOnline();
+	if (online)
+		onlineContacts_.insert(contact);
+	adjustContactsCount(online ? 1 : 0, 1);
+
 	model_->groupCache()->addContact(this, contact);
 }
 
@@ -238,24 +273,20 @@ CL_DEBUG("ContactListGroup(%x)::removeContact: %s (items = %d, contacts = %d)",
 	removeItem(findContact(contact));
 	contacts_.remove(index);
 
+	bool online = onlineContacts_.remove(contact);
+	adjustContactsCount(online ? -1 : 0, -1);
+
 	model_->groupCache()->removeContact(this, contact);
 }
 
-// Some room for future optimizations here
 ContactListItemProxy* ContactListGroup::findContact(PsiContact* contact) const
 {
-	foreach(ContactListItemProxy* item, items_)
-		if (item->item() == contact)
-			return item;
-	return 0;
+	return proxies_.value(contact);
 }
 
 ContactListItemProxy* ContactListGroup::findGroup(ContactListGroup* group) const
 {
-	foreach(ContactListItemProxy* item, items_)
-		if (item->item() == group)
-			return item;
-	return 0;
+	return proxies_.value(group);
 }
 
 // ContactListItemProxy* ContactListGroup::findAccount(ContactListAccountGroup* account) const
@@ -271,7 +302,16 @@ void ContactListGroup::contactUpdated(PsiContact* contact)
 	ContactListItemProxy* item = findContact(contact);
 	if (!item)
 		return;
-	updateOnlineContactsTimer_->start();
+
+	bool online = contact->isOnline();
+	if (online != onlineContacts_.contains(contact)) {
+		if (online)
+			onlineContacts_.insert(contact);
+		else
+			onlineContacts_.remove(contact);
+		adjustContactsCount(online ? 1 : -1, 0);
+	}
+
 	model_->updatedItem(item);
 }
 
@@ -284,8 +324,6 @@ void ContactListGroup::contactGroupsChanged(PsiContact* contact, QStringList con
 	else if (!findContact(contact)) {
 		addContact(contact, contactGroups);
 	}
-
-	updateOnlineContactsTimer_->start();
 }
 
 ContactListItemProxy* ContactListGroup::item(int index) const
@@ -300,14 +338,11 @@ int ContactListGroup::itemsCount() const
 	return items_.count();
 }
 
-// Some room for optimizations here
 int ContactListGroup::indexOf(const ContactListItem* item) const
 {
-	for (int i = 0; i < items_.count(); ++i)
-		if (items_.at(i)->item() == item)
-			return i;
-	Q_ASSERT(false);
-	return -1;
+	ContactListItemProxy* proxy = proxies_.value(item);
+	Q_ASSERT(proxy);
+	return proxy ? positions_.value(proxy) : -1;
 }
 
 ContactListGroup* ContactListGroup::parent() const
@@ -349,52 +384,47 @@ int ContactListGroup::contactsCount() const
 	return contacts_.count();
 }
 
+/**
+ * Applies a change in the number of online and total contacts to this
+ * group and all its ancestors, so presence updates cost O(depth) instead
+ * of recounting every group. Model notifications are still batched by
+ * updateOnlineContactsTimer_.
+ */
+void ContactListGroup::adjustContactsCount(int onlineDelta, int totalDelta)
+{
+	ContactListGroup* group = this;
+	while (group) {
+		group->onlineContactsCount_ += onlineDelta;
+		group->totalContactsCount_ += totalDelta;
+		Q_ASSERT(group->onlineContactsCount_ >= 0);
+		Q_ASSERT(group->totalContactsCount_ >= 0);
+		group->updateOnlineContactsTimer_->start();
+
+		if (!group->countedInParent_)
+			break;
+		group = group->parent();
+	}
+}
+
 void ContactListGroup::updateOnlineContactsFlag()
 {
 	updateOnlineContactsTimer_->stop();
-	if (!parent())
+	if (!parent() || !countedInParent_)
 		return;
 
-	bool haveOnlineContacts = false;
-	int onlineContactsCount = 0;
-	int totalContactsCount = 0;
-	foreach(ContactListItemProxy* item, items_) {
-		PsiContact* contact     = 0;
-		ContactListGroup* group = 0;
-		if ((contact = dynamic_cast<PsiContact*>(item->item()))) {
-			++totalContactsCount;
-			if (contact->isOnline()) {
-				haveOnlineContacts = true;
-				++onlineContactsCount;
-				// break;
-			}
-		}
-		else if ((group = dynamic_cast<ContactListGroup*>(item->item()))) {
-			totalContactsCount += group->totalContactsCount();
-			if (group->haveOnlineContacts()) {
-				haveOnlineContacts = true;
-				onlineContactsCount += group->onlineContactsCount();
-				// break;
-			}
-		}
-	}
-
+	bool haveOnlineContacts = onlineContactsCount_ > 0;
 	if (haveOnlineContacts_ != haveOnlineContacts) {
 		haveOnlineContacts_ = haveOnlineContacts;
-		if (parent()) {
-			parent()->updateOnlineContactsFlag();
-			model_->updatedGroupVisibility(this);
-		}
+		parent()->updateOnlineContactsFlag();
+		model_->updatedGroupVisibility(this);
 	}
 
-	if (onlineContactsCount != onlineContactsCount_ ||
-	    totalContactsCount != totalContactsCount_)
+	if (onlineContactsCount_ != notifiedOnlineContactsCount_ ||
+	    totalContactsCount_ != notifiedTotalContactsCount_)
 	{
-		onlineContactsCount_ = onlineContactsCount;
-		totalContactsCount_ = totalContactsCount;
-		if (parent()) {
-			model()->updatedItem(parent()->findGroup(this));
-		}
+		notifiedOnlineContactsCount_ = onlineContactsCount_;
+		notifiedTotalContactsCount_ = totalContactsCount_;
+		model()->updatedItem(parent()->findGroup(this));
 	}
 }
 
@@ -24,6 +24,8 @@
 #include "contactlistitem.h"
 
 #include <QVector>
+#include <QHash>
+#include <QSet>
 #include <QModelIndex>
 
 class QTimer;
@@ -109,6 +111,7 @@ protected:
 
 	virtual void clearGroup();
 	virtual void contactsHelper(QList<PsiContact*>* contacts) const;
+	void adjustContactsCount(int onlineDelta, int totalDelta);
 
 public slots:
 	void updateOnlineContactsFlag();
@@ -120,9 +123,15 @@ private:
 	QString name_;
 	QVector<PsiContact*> contacts_;
 	QVector<ContactListItemProxy*> items_;
+	QHash<ContactListItemProxy*, int> positions_;
+	QHash<const ContactListItem*, ContactListItemProxy*> proxies_;
+	QSet<const PsiContact*> onlineContacts_;
+	bool countedInParent_;
 	bool haveOnlineContacts_;
 	int onlineContactsCount_;
 	int totalContactsCount_;
+	int notifiedOnlineContactsCount_;
+	int notifiedTotalContactsCount_;
 
 	void removeContact(PsiContact* contact);
 #ifdef UNIT_TEST
@@ -22,6 +22,15 @@
 
 #include "psicontact.h"
 
+#include <string.h>
+
+#if defined(Q_OS_WIN)
+# include <windows.h>
+#elif defined(Q_OS_UNIX) && !defined(Q_OS_MAC)
+# include <stdlib.h>
+# include <QVector>
+#endif
+
 ContactListItem::ContactListItem(QObject* parent)
 	: QObject(parent)
 	, editing_(false)
@@ -102,3 +111,63 @@ const QString& ContactListItem::displayName() const
 {
 	return name();
 }
+
+/**
+ * Returns a byte string whose binary ordering (see compareKeys()) matches
+ * QString::localeAwareCompare() for \a str. Computing it once per item
+ * lets sorting avoid a collation call per comparison.
+ */
+QByteArray ContactListItem::collationKey(const QString& str)
+{
+#if defined(Q_OS_WIN)
+	// QString::localeAwareCompare() uses CompareString() on Windows
+	const wchar_t* src = reinterpret_cast<const wchar_t*>(str.utf16());
+	int size = LCMapStringW(LOCALE_USER_DEFAULT, LCMAP_SORTKEY, src, str.length(), 0, 0);
+	if (size > 0) {
+		QByteArray key(size, '\0');
+		LCMapStringW(LOCALE_USER_DEFAULT, LCMAP_SORTKEY, src, str.length(),
+		             reinterpret_cast<wchar_t*>(key.data()), size);
+		key.resize(qstrlen(key.constData()));
+		return key;
+	}
+#elif defined(Q_OS_UNIX) && !defined(Q_OS_MAC)
+	// ...and strcoll() on the local 8-bit encoding elsewhere on Unix
+	QByteArray local = str.toLocal8Bit();
+	QVector<char> buf(local.size() * 4 + 16);
+	size_t size = strxfrm(buf.data(), local.constData(), buf.size());
+	if (size >= size_t(buf.size())) {
+		buf.resize(int(size) + 1);
+		size = strxfrm(buf.data(), local.constData(), buf.size());
+	}
+	return QByteArray(buf.constData(), int(size));
+#endif
+	return binaryKey(str.toLower());
+}
+
+/**
+ * Returns \a str as big-endian UTF-16, so that compareKeys() orders the
+ * keys exactly as QString::operator<() orders the strings.
+ */
+QByteArray ContactListItem::binaryKey(const QString& str)
+{
+	QByteArray key(str.length() * 2, '\0');
+	const ushort* src = str.utf16();
+	char* dst = key.data();
+	for (int i = 0; i < str.length(); ++i) {
+		*dst++ = char(src[i] >> 8);
+		*dst++ = char(src[i] & 0xff);
+	}
+	return key;
+}
+
+/**
+ * Binary comparison of two sort keys, returns negative, zero or positive
+ * like memcmp(). Unlike QByteArray::operator<() it doesn't stop at zero bytes.
+ */
+int ContactListItem::compareKeys(const QByteArray& a, const QByteArray& b)
+{
+	int cmp = memcmp(a.constData(), b.constData(), qMin(a.size(), b.size()));
+	if (cmp)
+		return cmp;
+	return a.size() - b.size();
+}
@@ -23,6 +23,7 @@
 
 #include <QObject>
 #include <QString>
+#include <QByteArray>
 
 #include "contactlistmodel.h"
 
@@ -58,6 +59,10 @@ public:
 	virtual bool editing() const;
 	virtual void setEditing(bool editing);
 
+	static QByteArray collationKey(const QString& str);
+	static QByteArray binaryKey(const QString& str);
+	static int compareKeys(const QByteArray& a, const QByteArray& b);
+
 private:
 	bool editing_;
 };
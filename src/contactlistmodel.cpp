@@ -37,6 +37,8 @@
 #include "contactlistgroupcache.h"
 #include "contactlistmodelupdater.h"
 #include "contactlistspecialgroup.h"
+#include "contactlistrowsnapshot.h"
+#include "common.h"
 #include "userlist.h"
 #ifdef YAPSI
 #include "yacommon.h"
@@ -489,7 +491,7 @@ QVariant ContactListModel::contactData(const PsiContact* contact, int role) cons
 		return QVariant(contact->jid().full());
 	}
 	else if (role == Qt::ToolTipRole) {
-		return QVariant(contact->userListItem().makeTip(true, false));
+		return QVariant(contact->toolTip());
 	}
 	else if (role == PictureRole) {
 		return QVariant(contact->picture());
@@ -524,6 +526,9 @@ QVariant ContactListModel::contactData(const PsiContact* contact, int role) cons
 	else if (role == PhaseRole) {
 		return QVariant(false);
 	}
+	else if (role == RowSnapshotRole) {
+		return contactRowSnapshot(contact);
+	}
 #ifdef YAPSI
 	else if (role == Qt::ForegroundRole) {
 		return QVariant(Ya::statusColor(contact->status().type()));
@@ -542,6 +547,40 @@ QVariant ContactListModel::contactData(const PsiContact* contact, int role) cons
 	return contactListItemData(contact, role);
 }
 
+/**
+ * Collects everything a delegate needs to paint \a contact into one
+ * ContactListRowSnapshot. Roles which subclasses may override are still
+ * fetched through contactData().
+ */
+QVariant ContactListModel::contactRowSnapshot(const PsiContact* contact) const
+{
+	ContactListRowSnapshot snapshot;
+	snapshot.revision = contact->revision();
+	snapshot.name = contactData(contact, Qt::DisplayRole).toString();
+	snapshot.jid = contact->jid().full();
+	snapshot.statusText = contact->statusText().simplified();
+	snapshot.statusType = contact->status().type();
+	snapshot.isAlerting = contact->alerting();
+	snapshot.isAnimated = contact->isAnimated();
+	snapshot.phase = snapshot.isAnimated && contactData(contact, PhaseRole).toBool();
+	if (snapshot.isAlerting)
+		snapshot.alertPicture = contact->alertPicture();
+
+	int s = snapshot.statusType;
+	if (!contact->userListItem().presenceError().isEmpty()) {
+		s = STATUS_ERROR;
+	}
+	else if (!contact->isAgent() && s == XMPP::Status::Offline) {
+		if (contact->askingForAuth())
+			s = STATUS_ASK;
+		else if (!contact->authorizesToSeeStatus())
+			s = STATUS_NOAUTH;
+	}
+	snapshot.iconStatus = s;
+
+	return qVariantFromValue(snapshot);
+}
+
 QVariant ContactListModel::data(const QModelIndex &index, int role) const
 {
 	if (!index.isValid())
@@ -78,6 +78,7 @@ public:
 		AlertPictureRole = Qt::UserRole + 11,
 		IsAnimRole = Qt::UserRole + 21,
 		PhaseRole = Qt::UserRole + 22,
+		RowSnapshotRole = Qt::UserRole + 23,
 
 		// groups
 		ExpandedRole = Qt::UserRole + 12,
@@ -150,6 +151,7 @@ public:
 	virtual QVariant contactData(const PsiContact* contact, int role) const;
 	virtual QVariant contactGroupData(const ContactListGroup* group, int role) const;
 	virtual QVariant accountData(const ContactListAccountGroup* account, int role) const;
+	virtual QVariant contactRowSnapshot(const PsiContact* contact) const;
 
 	// reimplemented
 	QVariant data(const QModelIndex& index, int role) const;
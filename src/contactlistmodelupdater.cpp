@@ -25,18 +25,37 @@
 #include "psicontactlist.h"
 #include "psicontact.h"
 
-static const int MAX_COMMIT_DELAY = 30; // in seconds
+// Changes arriving after IDLE_TIME msecs without a commit are committed on
+// the next event loop iteration. While contacts keep being queued at
+// BURST_RATE or more per second the window is doubled on every commit, up
+// to MAX_COMMIT_INTERVAL, and otherwise halved, but not below
+// MIN_COMMIT_INTERVAL until the updater goes idle. The rate is taken from
+// the contacts queued while a commit was already pending, as a login
+// flood trickles in a few stanzas per socket read.
+static const int IDLE_TIME = 500; // in msecs
+static const int BURST_RATE = 50; // in contacts per second
+static const int MIN_COMMIT_INTERVAL = 50; // in msecs
+static const int MAX_COMMIT_INTERVAL = 1000; // in msecs
+
+// Above this many contacts in a single commit the model is rebuilt with
+// one reset instead of emitting row signals for each of them.
+static const int RESET_THRESHOLD = 100;
 
 ContactListModelUpdater::ContactListModelUpdater(PsiContactList* contactList, QObject *parent)
 	: QObject(parent)
 	, updatesEnabled_(true)
 	, contactList_(contactList)
 	, commitTimer_(0)
+	, commitInterval_(0)
+	, queuedSince_(-1)
+	, queuedWhilePending_(0)
+	, lastCommit_(-1)
 {
+	clock_.start();
+
 	commitTimer_ = new QTimer(this);
 	connect(commitTimer_, SIGNAL(timeout()), SLOT(commit()));
 	commitTimer_->setSingleShot(true);
-	commitTimer_->setInterval(100);
 
 	connect(contactList_, SIGNAL(addedContact(PsiContact*)), SLOT(addContact(PsiContact*)));
 	connect(contactList_, SIGNAL(removedContact(PsiContact*)), SLOT(removeContact(PsiContact*)));
@@ -57,6 +76,8 @@ void ContactListModelUpdater::clear()
 	}
 	monitoredContacts_.clear();
 	operationQueue_.clear();
+	queuedSince_ = -1;
+	queuedWhilePending_ = 0;
 }
 
 void ContactListModelUpdater::commit()
@@ -66,12 +87,13 @@ void ContactListModelUpdater::commit()
 
 // qWarning("updater(%x):commit", (int)this);
 	// qWarning("*** ContactListModelUpdater::commit(). operationQueue_.count() = %d", operationQueue_.count());
-	commitTimerStartTime_ = QDateTime();
 	commitTimer_->stop();
 	if (operationQueue_.isEmpty())
 		return;
 
-	bool doBulkUpdate = operationQueue_.count() > 1;
+	qint64 started = clock_.elapsed();
+	int count = operationQueue_.count();
+	bool doBulkUpdate = count > RESET_THRESHOLD;
 	if (doBulkUpdate)
 		emit beginBulkContactUpdate();
 
@@ -96,6 +118,27 @@ void ContactListModelUpdater::commit()
 		emit endBulkContactUpdate();
 
 	operationQueue_.clear();
+
+	lastCommit_ = clock_.elapsed();
+	int duration = int(lastCommit_ - started);
+	++stats_.commits;
+	if (doBulkUpdate)
+		++stats_.resets;
+	stats_.operations += count;
+	stats_.lastCommitMsecs = duration;
+	stats_.maxCommitMsecs = qMax(stats_.maxCommitMsecs, duration);
+	stats_.totalCommitMsecs += duration;
+	int waited = queuedSince_ >= 0 ? int(started - queuedSince_) : 0;
+	stats_.maxLatencyMsecs = qMax(stats_.maxLatencyMsecs, waited);
+
+	bool burst = queuedWhilePending_ * 1000 >= BURST_RATE * qMax(waited, 1);
+	if (burst)
+		commitInterval_ = qBound(MIN_COMMIT_INTERVAL, commitInterval_ * 2, MAX_COMMIT_INTERVAL);
+	else
+		commitInterval_ = qMax(MIN_COMMIT_INTERVAL, commitInterval_ / 2);
+
+	queuedSince_ = -1;
+	queuedWhilePending_ = 0;
 }
 
 void ContactListModelUpdater::addContact(PsiContact* contact)
@@ -178,18 +221,29 @@ void ContactListModelUpdater::addOperation(PsiContact* contact, ContactListModel
 {
 	if (!operationQueue_.contains(contact)) {
 		operationQueue_[contact] = operation;
+		if (commitTimer_->isActive())
+			++queuedWhilePending_;
 	}
 	else {
 		operationQueue_[contact] |= operation;
 	}
 
-	if (commitTimerStartTime_.isNull())
-		commitTimerStartTime_ = QDateTime::currentDateTime();
+	stats_.maxQueueDepth = qMax(stats_.maxQueueDepth, operationQueue_.count());
 
-	if (commitTimerStartTime_.secsTo(QDateTime::currentDateTime()) > MAX_COMMIT_DELAY)
-		commit();
-	else
-		commitTimer_->start();
+	if (queuedSince_ < 0)
+		queuedSince_ = clock_.elapsed();
+
+	// the window is not extended by changes arriving while it is open,
+	// so a steady stream of them can't hold commits back
+	if (!commitTimer_->isActive())
+		scheduleCommit();
+}
+
+void ContactListModelUpdater::scheduleCommit()
+{
+	if (lastCommit_ < 0 || clock_.elapsed() - lastCommit_ > IDLE_TIME)
+		commitInterval_ = 0;
+	commitTimer_->start(commitInterval_);
 }
 
 int ContactListModelUpdater::simplifiedOperationList(int operations) const
@@ -210,7 +264,34 @@ void ContactListModelUpdater::setUpdatesEnabled(bool updatesEnabled)
 	if (updatesEnabled_ != updatesEnabled) {
 		updatesEnabled_ = updatesEnabled;
 		if (updatesEnabled_) {
-			commitTimer_->start();
+			scheduleCommit();
 		}
 	}
 }
+
+/**
+ * Number of contacts with changes waiting for the next commit.
+ */
+int ContactListModelUpdater::queueDepth() const
+{
+	return operationQueue_.count();
+}
+
+/**
+ * Current commit window in msecs, 0 when the updater was idle before the
+ * changes now queued.
+ */
+int ContactListModelUpdater::commitInterval() const
+{
+	return commitInterval_;
+}
+
+const ContactListModelUpdater::Stats& ContactListModelUpdater::stats() const
+{
+	return stats_;
+}
+
+void ContactListModelUpdater::resetStats()
+{
+	stats_ = Stats();
+}
@@ -23,7 +23,7 @@
 
 #include <QObject>
 #include <QHash>
-#include <QDateTime>
+#include <QElapsedTimer>
 
 class QTimer;
 
@@ -40,6 +40,38 @@ public:
 	bool updatesEnabled() const;
 	void setUpdatesEnabled(bool updatesEnabled);
 
+	/**
+	 * \brief Commit counters, see stats()
+	 */
+	class Stats
+	{
+	public:
+		Stats()
+			: commits(0)
+			, resets(0)
+			, operations(0)
+			, maxQueueDepth(0)
+			, lastCommitMsecs(0)
+			, maxCommitMsecs(0)
+			, totalCommitMsecs(0)
+			, maxLatencyMsecs(0)
+		{}
+
+		int commits;          //!< non-empty commits
+		int resets;           //!< commits which were done as a model reset
+		int operations;       //!< contacts committed in total
+		int maxQueueDepth;
+		int lastCommitMsecs;
+		int maxCommitMsecs;
+		int totalCommitMsecs;
+		int maxLatencyMsecs;  //!< longest time a change has waited to be committed
+	};
+
+	int queueDepth() const;
+	int commitInterval() const;
+	const Stats& stats() const;
+	void resetStats();
+
 public slots:
 	void commit();
 	void clear();
@@ -73,7 +105,12 @@ private:
 	bool updatesEnabled_;
 	PsiContactList* contactList_;
 	QTimer* commitTimer_;
-	QDateTime commitTimerStartTime_;
+	int commitInterval_;
+	QElapsedTimer clock_;
+	qint64 queuedSince_;
+	int queuedWhilePending_;
+	qint64 lastCommit_;
+	Stats stats_;
 	QHash<PsiContact*, bool> monitoredContacts_;
 
 	enum Operation {
@@ -86,6 +123,7 @@ private:
 	QHash<PsiContact*, int> operationQueue_;
 
 	void addOperation(PsiContact* contact, Operation operation);
+	void scheduleCommit();
 	int simplifiedOperationList(int operations) const;
 };
 
@@ -29,6 +29,7 @@
 
 ContactListProxyModel::ContactListProxyModel(QObject* parent)
 	: QSortFilterProxyModel(parent)
+	, sortByStatus_(true)
 {
 	sort(0, Qt::AscendingOrder);
 	setDynamicSortFilter(true);
@@ -38,6 +39,7 @@ void ContactListProxyModel::setSourceModel(QAbstractItemModel* model)
 {
 	Q_ASSERT(dynamic_cast<ContactListModel*>(model));
 	QSortFilterProxyModel::setSourceModel(model);
+	sortByStatus_ = static_cast<ContactListModel*>(model)->contactSortStyle() == "status";
 	connect(model, SIGNAL(showOfflineChanged()), SLOT(filterParametersChanged()));
 	connect(model, SIGNAL(showSelfChanged()), SLOT(filterParametersChanged()));
 	connect(model, SIGNAL(showTransportsChanged()), SLOT(filterParametersChanged()));
@@ -144,15 +146,18 @@ bool ContactListProxyModel::lessThan(const QModelIndex& left, const QModelIndex&
 	if (!item1 || !item2)
 		return false;
 
-	ContactListModel *model = static_cast<ContactListModel*>(sourceModel());
-	if((model->contactSortStyle() == "status") ||
-	   !dynamic_cast<const PsiContact*>(item1->item()) ||
-	   !dynamic_cast<const PsiContact*>(item2->item()) ) {
+	// contacts carry precomputed sort keys, so the most frequent case
+	// doesn't need to go through collation on every comparison
+	if (item1->item()->type() != ContactListModel::ContactType ||
+	    item2->item()->type() != ContactListModel::ContactType) {
 		return item1->item()->compare(item2->item());
 	}
-	else {
-		return item1->item()->name().toLower() < item2->item()->name().toLower();
-	}
+
+	const PsiContact* contact1 = static_cast<const PsiContact*>(item1->item());
+	const PsiContact* contact2 = static_cast<const PsiContact*>(item2->item());
+	if (sortByStatus_)
+		return ContactListItem::compareKeys(contact1->statusSortKey(), contact2->statusSortKey()) < 0;
+	return ContactListItem::compareKeys(contact1->nameSortKey(), contact2->nameSortKey()) < 0;
 }
 
 void ContactListProxyModel::filterParametersChanged()
@@ -163,5 +168,7 @@ void ContactListProxyModel::filterParametersChanged()
 
 void ContactListProxyModel::updateSorting()
 {
+	if (sourceModel())
+		sortByStatus_ = static_cast<ContactListModel*>(sourceModel())->contactSortStyle() == "status";
 	invalidate();
 }
@@ -50,6 +50,9 @@ protected:
 
 private slots:
 	void filterParametersChanged();
+
+private:
+	bool sortByStatus_;
 };
 
 #endif
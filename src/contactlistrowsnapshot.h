@@ -0,0 +1,64 @@
+/*
+ * contactlistrowsnapshot.h - everything the roster delegate needs to paint a contact
+ * Copyright (C) 2026  Psi Team
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#ifndef CONTACTLISTROWSNAPSHOT_H
+#define CONTACTLISTROWSNAPSHOT_H
+
+#include <QMetaType>
+#include <QString>
+#include <QIcon>
+
+#include "xmpp_status.h"
+
+/**
+ * \brief Contact row data returned by ContactListModel::RowSnapshotRole
+ *
+ * Lets the delegate fetch a contact row in one data() call instead of
+ * a dozen. \a revision changes whenever the contact emits updated(), and
+ * is unique across contacts, so it can be used as a paint cache key.
+ * Alerting and animation state change without a new revision.
+ */
+class ContactListRowSnapshot
+{
+public:
+	ContactListRowSnapshot()
+		: revision(0)
+		, statusType(XMPP::Status::Offline)
+		, iconStatus(XMPP::Status::Offline)
+		, isAlerting(false)
+		, isAnimated(false)
+		, phase(false)
+	{}
+
+	uint revision;
+	QString name;
+	QString jid;
+	QString statusText;
+	XMPP::Status::Type statusType;
+	int iconStatus; //!< status for PsiIconset::statusPtr(), may be STATUS_ERROR etc.
+	bool isAlerting;
+	bool isAnimated;
+	bool phase;
+	QIcon alertPicture; //!< only set when isAlerting
+};
+
+Q_DECLARE_METATYPE(ContactListRowSnapshot)
+
+#endif
@@ -0,0 +1,294 @@
+/*
+ * contactlistsearchindex.cpp - prefix index of roster contact names, JIDs and groups
+ * Copyright (C) 2026  Psi Team
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#include "contactlistsearchindex.h"
+
+#include <QtAlgorithms>
+
+#include "psicontactlist.h"
+#include "psicontact.h"
+
+//----------------------------------------------------------------------------
+// ContactListSearchIndex::Node
+//----------------------------------------------------------------------------
+
+class ContactListSearchIndex::Node
+{
+public:
+	Node(Node* _parent = 0, QChar _key = QChar())
+		: parent(_parent)
+		, key(_key)
+	{}
+
+	~Node()
+	{
+		qDeleteAll(children);
+	}
+
+	void collect(QSet<PsiContact*>* result) const
+	{
+		*result += contacts;
+		foreach(Node* child, children)
+			child->collect(result);
+	}
+
+	Node* parent;
+	QChar key;
+	QHash<QChar, Node*> children;
+	QSet<PsiContact*> contacts; //!< contacts having a word ending at this node
+};
+
+//----------------------------------------------------------------------------
+// ContactListSearchIndex
+//----------------------------------------------------------------------------
+
+ContactListSearchIndex::ContactListSearchIndex(PsiContactList* contactList, QObject* parent)
+	: QObject(parent)
+	, contactList_(contactList)
+	, root_(new Node())
+{
+	connect(contactList_, SIGNAL(addedContact(PsiContact*)), SLOT(addContact(PsiContact*)));
+	connect(contactList_, SIGNAL(removedContact(PsiContact*)), SLOT(removeContact(PsiContact*)));
+
+	foreach(PsiContact* contact, contactList_->contacts())
+		addContact(contact);
+}
+
+ContactListSearchIndex::~ContactListSearchIndex()
+{
+	delete root_;
+}
+
+/**
+ * Returns \a text in lower case with diacritic marks stripped, so that
+ * e.g. "Élodie" and "elodie" fold to the same string.
+ */
+QString ContactListSearchIndex::fold(const QString& text)
+{
+	QString decomposed = text.normalized(QString::NormalizationForm_KD).toLower();
+	QString result;
+	result.reserve(decomposed.length());
+	for (int i = 0; i < decomposed.length(); ++i) {
+		QChar::Category category = decomposed[i].category();
+		if (category != QChar::Mark_NonSpacing &&
+		    category != QChar::Mark_SpacingCombining &&
+		    category != QChar::Mark_Enclosing)
+		{
+			result += decomposed[i];
+		}
+	}
+	return result;
+}
+
+/**
+ * Splits folded \a text into words of letters and digits. Used both for
+ * indexed strings and for queries.
+ */
+QStringList ContactListSearchIndex::tokenize(const QString& text)
+{
+	QStringList result;
+	QString folded = fold(text);
+	int start = -1;
+	for (int i = 0; i <= folded.length(); ++i) {
+		bool inWord = i < folded.length() && folded[i].isLetterOrNumber();
+		if (inWord && start < 0) {
+			start = i;
+		}
+		else if (!inWord && start >= 0) {
+			result += folded.mid(start, i - start);
+			start = -1;
+		}
+	}
+	return result;
+}
+
+/**
+ * Returns all contacts matching every word of \a words, which must come
+ * from tokenize(). Empty \a words match all contacts.
+ */
+QSet<PsiContact*> ContactListSearchIndex::search(const QStringList& words) const
+{
+	QSet<PsiContact*> result;
+	if (words.isEmpty()) {
+		foreach(PsiContact* contact, entries_.keys())
+			result += contact;
+		return result;
+	}
+
+	// walk the trie for the longest word, it's likely the rarest one
+	QString longest;
+	foreach(const QString& word, words) {
+		if (word.length() > longest.length())
+			longest = word;
+	}
+
+	const Node* node = root_;
+	for (int i = 0; node && i < longest.length(); ++i)
+		node = node->children.value(longest[i]);
+	if (!node)
+		return result;
+	node->collect(&result);
+
+	if (words.count() > 1) {
+		QSet<PsiContact*>::iterator it = result.begin();
+		while (it != result.end()) {
+			if (matches(*it, words))
+				++it;
+			else
+				it = result.erase(it);
+		}
+	}
+	return result;
+}
+
+/**
+ * Returns true if each of \a words is a prefix of one of \a contact's
+ * words. This lets a caller narrow a previous result set when the query
+ * is extended instead of searching again.
+ */
+bool ContactListSearchIndex::matches(PsiContact* contact, const QStringList& words) const
+{
+	QHash<PsiContact*, Entry>::const_iterator it = entries_.constFind(contact);
+	if (it == entries_.constEnd())
+		return false;
+
+	foreach(const QString& word, words) {
+		bool found = false;
+		foreach(const QString& token, it.value().tokens) {
+			if (token.startsWith(word)) {
+				found = true;
+				break;
+			}
+		}
+		if (!found)
+			return false;
+	}
+	return true;
+}
+
+void ContactListSearchIndex::addContact(PsiContact* contact)
+{
+	if (entries_.contains(contact))
+		return;
+
+	connect(contact, SIGNAL(updated()), SLOT(contactUpdated()));
+	connect(contact, SIGNAL(groupsChanged()), SLOT(contactUpdated()));
+
+	Entry& entry = entries_[contact];
+	entry.name = contact->name();
+	entry.jid = contact->jid().bare();
+	entry.groups = contact->groups();
+	setTokens(contact, entry, tokenize(entry));
+	emit contactChanged(contact);
+}
+
+void ContactListSearchIndex::removeContact(PsiContact* contact)
+{
+	if (!entries_.contains(contact))
+		return;
+
+	disconnect(contact, 0, this, 0);
+	foreach(const QString& token, entries_.take(contact).tokens)
+		removeToken(token, contact);
+	emit contactRemoved(contact);
+}
+
+void ContactListSearchIndex::contactUpdated()
+{
+	PsiContact* contact = static_cast<PsiContact*>(sender());
+	QHash<PsiContact*, Entry>::iterator it = entries_.find(contact);
+	if (it == entries_.end())
+		return;
+
+	// most updates are presence changes which leave the strings alone,
+	// only compare them then
+	Entry& entry = it.value();
+	QString name = contact->name();
+	QString jid = contact->jid().bare();
+	QStringList groups = contact->groups();
+	if (name == entry.name && jid == entry.jid && groups == entry.groups)
+		return;
+
+	entry.name = name;
+	entry.jid = jid;
+	entry.groups = groups;
+	QStringList tokens = tokenize(entry);
+	if (tokens == entry.tokens)
+		return;
+
+	setTokens(contact, entry, tokens);
+	emit contactChanged(contact);
+}
+
+/**
+ * Returns the sorted, distinct words of \a entry's strings.
+ */
+QStringList ContactListSearchIndex::tokenize(const Entry& entry)
+{
+	QStringList tokens;
+	tokens += tokenize(entry.name);
+	tokens += tokenize(entry.jid);
+	foreach(const QString& group, entry.groups)
+		tokens += tokenize(group);
+
+	tokens = tokens.toSet().toList();
+	qSort(tokens);
+	return tokens;
+}
+
+void ContactListSearchIndex::setTokens(PsiContact* contact, Entry& entry, const QStringList& tokens)
+{
+	foreach(const QString& token, entry.tokens)
+		removeToken(token, contact);
+	foreach(const QString& token, tokens)
+		insertToken(token, contact);
+	entry.tokens = tokens;
+}
+
+void ContactListSearchIndex::insertToken(const QString& token, PsiContact* contact)
+{
+	Node* node = root_;
+	for (int i = 0; i < token.length(); ++i) {
+		Node* child = node->children.value(token[i]);
+		if (!child) {
+			child = new Node(node, token[i]);
+			node->children.insert(token[i], child);
+		}
+		node = child;
+	}
+	node->contacts += contact;
+}
+
+void ContactListSearchIndex::removeToken(const QString& token, PsiContact* contact)
+{
+	Node* node = root_;
+	for (int i = 0; node && i < token.length(); ++i)
+		node = node->children.value(token[i]);
+	if (!node)
+		return;
+
+	node->contacts.remove(contact);
+	while (node != root_ && node->contacts.isEmpty() && node->children.isEmpty()) {
+		Node* parent = node->parent;
+		parent->children.remove(node->key);
+		delete node;
+		node = parent;
+	}
+}
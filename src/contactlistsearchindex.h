@@ -0,0 +1,87 @@
+/*
+ * contactlistsearchindex.h - prefix index of roster contact names, JIDs and groups
+ * Copyright (C) 2026  Psi Team
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#ifndef CONTACTLISTSEARCHINDEX_H
+#define CONTACTLISTSEARCHINDEX_H
+
+#include <QObject>
+#include <QHash>
+#include <QSet>
+#include <QStringList>
+#include <QPointer>
+
+class PsiContact;
+class PsiContactList;
+
+/**
+ * \brief Token prefix index over all contacts of a PsiContactList
+ *
+ * Names, JIDs and group names are split into words of letters and digits,
+ * folded to lower case without diacritics, and kept in a prefix trie.
+ * A query matches a contact when each of its words is a prefix of one of
+ * the contact's words.
+ */
+class ContactListSearchIndex : public QObject
+{
+	Q_OBJECT
+public:
+	ContactListSearchIndex(PsiContactList* contactList, QObject* parent);
+	~ContactListSearchIndex();
+
+	static QString fold(const QString& text);
+	static QStringList tokenize(const QString& text);
+
+	QSet<PsiContact*> search(const QStringList& words) const;
+	bool matches(PsiContact* contact, const QStringList& words) const;
+
+signals:
+	/**
+	 * Emitted after \a contact was added to the index or its words changed.
+	 */
+	void contactChanged(PsiContact* contact);
+	void contactRemoved(PsiContact* contact);
+
+private slots:
+	void addContact(PsiContact* contact);
+	void removeContact(PsiContact* contact);
+	void contactUpdated();
+
+private:
+	class Node;
+
+	// the strings a contact's words were taken from, and the words
+	struct Entry {
+		QString name;
+		QString jid;
+		QStringList groups;
+		QStringList tokens;
+	};
+
+	QPointer<PsiContactList> contactList_;
+	Node* root_;
+	QHash<PsiContact*, Entry> entries_;
+
+	static QStringList tokenize(const Entry& entry);
+	void setTokens(PsiContact* contact, Entry& entry, const QStringList& tokens);
+	void insertToken(const QString& token, PsiContact* contact);
+	void removeToken(const QString& token, PsiContact* contact);
+};
+
+#endif
@@ -180,16 +180,7 @@ void ContactListViewDelegate::drawText(QPainter* painter, const QStyleOptionView
 	if (text.isEmpty())
 		return;
 
-	QPalette::ColorGroup cg = option.state & QStyle::State_Enabled
-							  ? QPalette::Normal : QPalette::Disabled;
-	if (cg == QPalette::Normal && !(option.state & QStyle::State_Active))
-		cg = QPalette::Inactive;
-	if (option.state & QStyle::State_Selected) {
-		painter->setPen(option.palette.color(cg, QPalette::HighlightedText));
-	}
-	else {
-		painter->setPen(option.palette.color(cg, QPalette::Text));
-	}
+	setTextPen(painter, option);
 
 	QString txt = text;
 	if (rect.width() < option.fontMetrics.width(text)) {
@@ -219,6 +210,20 @@ void ContactListViewDelegate::drawText(QPainter* painter, const QStyleOptionView
 	}
 }
 
+void ContactListViewDelegate::setTextPen(QPainter* painter, const QStyleOptionViewItem& option) const
+{
+	QPalette::ColorGroup cg = option.state & QStyle::State_Enabled
+							  ? QPalette::Normal : QPalette::Disabled;
+	if (cg == QPalette::Normal && !(option.state & QStyle::State_Active))
+		cg = QPalette::Inactive;
+	if (option.state & QStyle::State_Selected) {
+		painter->setPen(option.palette.color(cg, QPalette::HighlightedText));
+	}
+	else {
+		painter->setPen(option.palette.color(cg, QPalette::Text));
+	}
+}
+
 QSize ContactListViewDelegate::sizeHint(const QStyleOptionViewItem& option, const QModelIndex& index) const
 {
 	Q_UNUSED(option);
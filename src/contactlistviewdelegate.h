@@ -67,6 +67,7 @@ protected:
 	virtual void defaultDraw(QPainter* painter, const QStyleOptionViewItem& option) const;
 
 	virtual void drawText(QPainter* painter, const QStyleOptionViewItem& o, const QRect& rect, const QString& text, const QModelIndex& index) const;
+	void setTextPen(QPainter* painter, const QStyleOptionViewItem& option) const;
 	virtual void drawBackground(QPainter* painter, const QStyleOptionViewItem& option, const QModelIndex& index) const;
 
 	virtual QRect nameRect(const QStyleOptionViewItem& option, const QModelIndex& index) const = 0;
@@ -0,0 +1,62 @@
+/*
+ * edbpage.cpp - the run of event ids a history read covers
+ * Copyright (C) 2026  Psi Team
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#include "edbpage.h"
+
+EDBPage::EDBPage(int id, bool backward, int len, int total)
+	: first_(id)
+	, step_(backward ? -1 : 1)
+	, total_(total)
+{
+	if (id < 0 || id >= total || len < 0)
+		count_ = 0;
+	else if (backward)
+		count_ = qMin(len, id + 1);
+	else
+		count_ = qMin(len, total - id);
+}
+
+/**
+ * Number of ids the read examines.
+ */
+int EDBPage::count() const
+{
+	return count_;
+}
+
+/**
+ * The \a n th id examined, in walking order.
+ */
+int EDBPage::id(int n) const
+{
+	return first_ + n * step_;
+}
+
+/**
+ * Id the following read continues from, just past the last one examined
+ * here, or an empty string if this read reached the end of the log.
+ */
+QString EDBPage::nextId() const
+{
+	int next = first_ + count_ * step_;
+	if (next < 0 || next >= total_)
+		return QString();
+	return QString::number(next);
+}
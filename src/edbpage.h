@@ -0,0 +1,50 @@
+/*
+ * edbpage.h - the run of event ids a history read covers
+ * Copyright (C) 2026  Psi Team
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#ifndef EDBPAGE_H
+#define EDBPAGE_H
+
+#include <QString>
+
+/**
+ * \brief The run of event ids a single history read covers.
+ *
+ * A read starts at one id and walks up to a number of events in one
+ * direction, clipped to the ends of the log. Some of those events may not
+ * be readable, so where the next read has to continue is a property of the
+ * walk itself and not of the last event that made it into the result.
+ */
+class EDBPage
+{
+public:
+	EDBPage(int id, bool backward, int len, int total);
+
+	int count() const;
+	int id(int n) const;
+	QString nextId() const;
+
+private:
+	int first_;
+	int count_;
+	int step_;
+	int total_;
+};
+
+#endif
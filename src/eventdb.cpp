@@ -33,6 +33,7 @@
 #include "applicationinfo.h"
 #include "psievent.h"
 #include "jidutil.h"
+#include "edbpage.h"
 
 using namespace XMPP;
 
@@ -83,6 +84,7 @@ public:
 
 	EDB *edb;
 	EDBResult r;
+	QString nextId;
 	bool busy;
 	bool writeSuccess;
 	int listeningFor;
@@ -168,15 +170,26 @@ const EDBResult EDBHandle::result() const
 	return d->r;
 }
 
+/**
+ * Id a get() continues from to read on past the last result, in the same
+ * direction. Unlike the ids of the result items this accounts for events
+ * that were examined but couldn't be read. Empty at the end of the log.
+ */
+QString EDBHandle::nextId() const
+{
+	return d->nextId;
+}
+
 bool EDBHandle::writeSuccess() const
 {
 	return d->writeSuccess;
 }
 
-void EDBHandle::edb_resultReady(EDBResult r)
+void EDBHandle::edb_resultReady(EDBResult r, const QString &nextId)
 {
 	d->busy = false;
 	d->r = r;
+	d->nextId = nextId;
 	d->listeningFor = -1;
 	finished();
 }
@@ -275,12 +288,12 @@ int EDB::op_erase(const Jid &j)
 	return erase(j);
 }
 
-void EDB::resultReady(int req, EDBResult r)
+void EDB::resultReady(int req, EDBResult r, const QString &nextId)
 {
 	// deliver
 	foreach(EDBHandle* h, d->list) {
 		if(h->listeningFor() == req) {
-			h->edb_resultReady(r);
+			h->edb_resultReady(r, nextId);
 			return;
 		}
 	}
@@ -525,22 +538,10 @@ void EDBFlatFile::performRequests()
 			return;
 		}
 
-		int len;
-		if(direction == Forward) {
-			if(id + r->len > f->total())
-				len = f->total() - id;
-			else
-				len = r->len;
-		}
-		else {
-			if((id+1) - r->len < 0)
-				len = id+1;
-			else
-				len = r->len;
-		}
-
+		EDBPage page(id, direction == Backward, r->len, f->total());
 		EDBResult result;
-		for(int n = 0; n < len; ++n) {
+		for(int n = 0; n < page.count(); ++n) {
+			id = page.id(n);
 			PsiEvent *e = f->get(id);
 			if(e) {
 				QString prevId, nextId;
@@ -551,13 +552,8 @@ void EDBFlatFile::performRequests()
 				EDBItemPtr ei = EDBItemPtr(new EDBItem(e, QString::number(id), prevId, nextId));
 				result.append(ei);
 			}
-
-			if(direction == Forward)
-				++id;
-			else
-				--id;
 		}
-		resultReady(r->id, result);
+		resultReady(r->id, result, page.nextId());
 	}
 	else if(type == item_file_req::Type_append) {
 		writeFinished(r->id, f->append(r->event));
@@ -70,6 +70,7 @@ public:
 
 	bool busy() const;
 	const EDBResult result() const;
+	QString nextId() const;
 	bool writeSuccess() const;
 	int lastRequestType() const;
 
@@ -81,7 +82,7 @@ private:
 	Private *d;
 
 	friend class EDB;
-	void edb_resultReady(EDBResult);
+	void edb_resultReady(EDBResult, const QString &nextId);
 	void edb_writeFinished(bool);
 	int listeningFor() const;
 };
@@ -103,7 +104,7 @@ protected:
 	virtual int append(const XMPP::Jid &, PsiEvent *)=0;
 	virtual int find(const QString &, const XMPP::Jid &, const QString &id, int direction)=0;
 	virtual int erase(const XMPP::Jid &)=0;
-	void resultReady(int, EDBResult);
+	void resultReady(int, EDBResult, const QString &nextId = QString());
 	void writeFinished(int, bool);
 
 private:
@@ -0,0 +1,204 @@
+/*
+ * filereadahead.cpp - reads a file ahead of its consumer on a worker thread
+ * Copyright (C) 2026  Psi Team
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#include "filereadahead.h"
+
+#include <QFile>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QVector>
+#include <QWaitCondition>
+
+class FileReadAhead::Private
+{
+public:
+	QFile file;
+	qlonglong pos, end;
+	int chunkSize;
+
+	// ring of chunks, guarded by mutex. the worker fills the slot at
+	// (first + filled) % count, the consumer takes the one at first.
+	QMutex mutex;
+	QWaitCondition notFull;
+	QVector<QByteArray> chunks;
+	int first, filled;
+	bool stop;
+	QString errorString;
+};
+
+/**
+ * \class FileReadAhead
+ * \brief Reads a file into a ring of chunks on a worker thread
+ *
+ * Keeps up to a fixed number of chunks read ahead, so the consumer never
+ * waits for the disk while the network is ready for more data. Chunks are
+ * handed out as implicitly shared QByteArrays and their buffers are reused
+ * once the consumer has dropped them, so there is neither an allocation
+ * nor a copy per chunk in the steady state.
+ *
+ * readyRead() is emitted whenever a chunk becomes available while there
+ * was none, the consumer is expected to take everything it can handle
+ * then. error() is emitted if reading fails, see errorString().
+ */
+FileReadAhead::FileReadAhead(QObject *parent)
+	: QThread(parent)
+{
+	d = new Private;
+	d->pos = d->end = 0;
+	d->chunkSize = DefaultChunkSize;
+	d->first = d->filled = 0;
+	d->stop = false;
+}
+
+FileReadAhead::~FileReadAhead()
+{
+	close();
+	delete d;
+}
+
+/**
+ * Opens \a fileName and prepares reading \a length bytes starting at
+ * \a offset, in chunks of at most \a chunkSize bytes with at most
+ * \a chunks of them kept ready. Call start() to begin reading.
+ */
+bool FileReadAhead::open(const QString &fileName, qlonglong offset, qlonglong length, int chunkSize, int chunks)
+{
+	close();
+
+	d->file.setFileName(fileName);
+	if (!d->file.open(QIODevice::ReadOnly) || (offset && !d->file.seek(offset))) {
+		d->errorString = d->file.errorString();
+		d->file.close();
+		return false;
+	}
+
+	d->pos = offset;
+	d->end = offset + length;
+	d->chunkSize = qMax(1, chunkSize);
+	d->chunks.fill(QByteArray(), qMax(1, chunks));
+	d->first = d->filled = 0;
+	d->stop = false;
+	d->errorString = QString();
+	return true;
+}
+
+/**
+ * Stops the worker and closes the file. Chunks not taken yet are lost.
+ */
+void FileReadAhead::close()
+{
+	d->mutex.lock();
+	d->stop = true;
+	d->notFull.wakeAll();
+	d->mutex.unlock();
+	wait();
+
+	d->file.close();
+	d->chunks.clear();
+	d->filled = 0;
+}
+
+QString FileReadAhead::errorString() const
+{
+	QMutexLocker locker(&d->mutex);
+	return d->errorString;
+}
+
+bool FileReadAhead::hasChunk() const
+{
+	QMutexLocker locker(&d->mutex);
+	return d->filled > 0;
+}
+
+/**
+ * Returns size of the chunk takeChunk() would return, or 0 if there's
+ * none ready.
+ */
+int FileReadAhead::nextChunkSize() const
+{
+	QMutexLocker locker(&d->mutex);
+	return d->filled ? d->chunks.at(d->first).size() : 0;
+}
+
+/**
+ * Returns the next chunk of the file and lets the worker refill its slot.
+ * Returns an empty array if there's no chunk ready.
+ */
+QByteArray FileReadAhead::takeChunk()
+{
+	QMutexLocker locker(&d->mutex);
+	if (!d->filled)
+		return QByteArray();
+
+	QByteArray chunk = d->chunks.at(d->first);
+	d->first = (d->first + 1) % d->chunks.count();
+	if (d->filled-- == d->chunks.count())
+		d->notFull.wakeOne();
+	return chunk;
+}
+
+/**
+ * Returns true once all the requested data was read and taken.
+ */
+bool FileReadAhead::atEnd() const
+{
+	QMutexLocker locker(&d->mutex);
+	return d->pos == d->end && !d->filled;
+}
+
+void FileReadAhead::run()
+{
+	forever {
+		d->mutex.lock();
+		while (!d->stop && d->filled == d->chunks.count())
+			d->notFull.wait(&d->mutex);
+		if (d->stop || d->pos >= d->end) {
+			d->mutex.unlock();
+			break;
+		}
+		int slot = (d->first + d->filled) % d->chunks.count();
+		int size = (int)qMin((qlonglong)d->chunkSize, d->end - d->pos);
+		d->mutex.unlock();
+
+		// only this thread touches a slot which isn't filled. data()
+		// detaches, i.e. allocates, only if the previous chunk in this
+		// slot is still referenced by the consumer.
+		QByteArray &buf = d->chunks[slot];
+		buf.resize(size);
+		qint64 r = d->file.read(buf.data(), size);
+
+		d->mutex.lock();
+		if (r <= 0) {
+			// the file shrank under us, or a real read error
+			d->errorString = r < 0 ? d->file.errorString() : tr("Unexpected end of file");
+			d->mutex.unlock();
+			emit error();
+			break;
+		}
+		if (r < size)
+			buf.resize(r);
+		d->pos += r;
+		bool wasEmpty = d->filled++ == 0;
+		d->mutex.unlock();
+
+		if (wasEmpty)
+			emit readyRead();
+	}
+}
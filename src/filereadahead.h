@@ -0,0 +1,59 @@
+/*
+ * filereadahead.h - reads a file ahead of its consumer on a worker thread
+ * Copyright (C) 2026  Psi Team
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#ifndef FILEREADAHEAD_H
+#define FILEREADAHEAD_H
+
+#include <QThread>
+#include <QByteArray>
+
+class FileReadAhead : public QThread
+{
+	Q_OBJECT
+public:
+	enum { DefaultChunkSize = 16384, DefaultChunks = 8 };
+
+	FileReadAhead(QObject *parent = 0);
+	~FileReadAhead();
+
+	bool open(const QString &fileName, qlonglong offset, qlonglong length,
+	          int chunkSize = DefaultChunkSize, int chunks = DefaultChunks);
+	void close();
+	QString errorString() const;
+
+	bool hasChunk() const;
+	int nextChunkSize() const;
+	QByteArray takeChunk();
+	bool atEnd() const;
+
+signals:
+	void readyRead();
+	void error();
+
+protected:
+	// reimplemented
+	void run();
+
+private:
+	class Private;
+	Private *d;
+};
+
+#endif
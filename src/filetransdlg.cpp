@@ -3,12 +3,14 @@
 #include <QFileDialog>
 #include <QMessageBox>
 #include <QTimer>
+#include <QTime>
 #include <QPainter>
 #include <QDesktopServices>
 #include <QFileIconProvider>
 #include <QProcess>
 #include <QMenu>
 #include <QKeyEvent>
+#include <QCoreApplication>
 
 #include "psicon.h"
 #include "psiaccount.h"
@@ -25,6 +27,9 @@
 #include "accountlabel.h"
 #include "psioptions.h"
 #include "fileutil.h"
+#include "filereadahead.h"
+#include "filewritebehind.h"
+#include "filetransferstats.h"
 
 typedef quint64 LARGE_TYPE;
 
@@ -64,6 +69,9 @@ static int calcProgressStep(qlonglong big, int complement, int shift)
 	return ((big + complement) >> shift);
 }
 
+// minimum delay between progress reports of an incoming transfer, in msecs
+#define PROGRESSINTERVAL 100
+
 static QStringList *activeFiles = 0;
 
 static void active_file_add(const QString &s)
@@ -129,6 +137,11 @@ public:
 	QString desc;
 	bool sending;
 	QFile f;
+	FileReadAhead *reader;
+	qlonglong queued; // bytes passed to writeFileData() so far
+	bool sendScheduled;
+	FileWriteBehind *writer;
+	QTime lastProgress;
 	int shift;
 	int complement;
 	QString activeFile;
@@ -139,6 +152,10 @@ FileTransferHandler::FileTransferHandler(PsiAccount *pa, FileTransfer *ft)
 	d = new Private;
 	d->pa = pa;
 	d->c = 0;
+	d->reader = 0;
+	d->queued = 0;
+	d->sendScheduled = false;
+	d->writer = 0;
 
 	if(ft) {
 		d->sending = false;
@@ -164,6 +181,7 @@ FileTransferHandler::~FileTransferHandler()
 {
 	if(!d->activeFile.isEmpty())
 		active_file_remove(d->activeFile);
+	closeWriter();
 
 	if(d->ft) {
 		d->ft->close();
@@ -345,57 +363,53 @@ void FileTransferHandler::ft_connected()
 	d->sent = d->offset;
 
 	if(d->sending) {
-		// open the file, and set the correct offset
-		bool ok = false;
-		if(d->f.open(QIODevice::ReadOnly)) {
-			if(d->offset == 0) {
-				ok = true;
-			}
-			else {
-				if(d->f.seek(d->offset))
-					ok = true;
-			}
-		}
-		if(!ok) {
+		// open the file at the correct offset, it is read ahead in
+		// chunks on a worker thread. a chunk is never bigger than what
+		// the connection accepts at once.
+		d->queued = d->offset;
+		int chunkSize = d->ft->dataSizeNeeded();
+		if(chunkSize <= 0 || chunkSize > FileReadAhead::DefaultChunkSize)
+			chunkSize = FileReadAhead::DefaultChunkSize;
+
+		d->reader = new FileReadAhead(this);
+		connect(d->reader, SIGNAL(readyRead()), SLOT(trySend()));
+		connect(d->reader, SIGNAL(error()), SLOT(reader_error()));
+		if(!d->reader->open(d->f.fileName(), d->offset, d->fileSize - d->offset, chunkSize)) {
+			QString err = d->reader->errorString();
+			closeReader();
 			delete d->ft;
 			d->ft = 0;
-			error(ErrFile, 0, d->f.errorString());
+			error(ErrFile, 0, err);
 			return;
 		}
 
 		if(d->sent == d->fileSize)
 			QTimer::singleShot(0, this, SLOT(doFinish()));
 		else
-			QTimer::singleShot(0, this, SLOT(trySend()));
+			d->reader->start();
 	}
 	else {
-		// open the file, truncating if offset is zero, otherwise set the correct offset
-		QIODevice::OpenMode m = QIODevice::ReadWrite;
-		if(d->offset == 0)
-			m |= QIODevice::Truncate;
-		bool ok = false;
-		if(d->f.open(m)) {
-			if(d->offset == 0) {
-				ok = true;
-			}
-			else {
-				if(d->f.seek(d->offset))
-					ok = true;
-			}
-		}
-		if(!ok) {
+		// open the file, truncating if offset is zero, otherwise set the
+		// correct offset. it is written on a worker thread.
+		d->writer = new FileWriteBehind(this);
+		connect(d->writer, SIGNAL(error()), SLOT(writer_error()));
+		connect(d->writer, SIGNAL(finished()), SLOT(writer_finished()));
+		if(!d->writer->open(d->f.fileName(), d->offset, d->fileSize)) {
+			QString err = d->writer->errorString();
+			closeWriter();
 			delete d->ft;
 			d->ft = 0;
-			error(ErrFile, 0, d->f.errorString());
+			error(ErrFile, 0, err);
 			return;
 		}
+		d->lastProgress.start();
 
 		d->activeFile = d->f.fileName();
 		active_file_add(d->activeFile);
 
 		// done already?  this means a file size of zero
 		if(d->sent == d->fileSize)
-			QTimer::singleShot(0, this, SLOT(doFinish()));
+			d->writer->finish();
 	}
 
 	emit connected();
@@ -405,16 +419,22 @@ void FileTransferHandler::ft_readyRead(const QByteArray &a)
 {
 	if(!d->sending) {
 		//printf("%d bytes read\n", a.size());
-		int r = d->f.write(a.data(), a.size());
-		if(r < 0) {
-			d->f.close();
-			delete d->ft;
-			d->ft = 0;
-			error(ErrFile, 0, d->f.errorString());
+		if(!d->writer)
 			return;
-		}
+		d->writer->write(a);
 		d->sent += a.size();
-		doFinish();
+
+		// the final progress is reported once it's all on disk
+		if(d->sent == d->fileSize) {
+			d->writer->finish();
+			return;
+		}
+
+		// don't bother the ui with every packet
+		if(d->lastProgress.elapsed() >= PROGRESSINTERVAL) {
+			d->lastProgress.restart();
+			progress(calcProgressStep(d->sent, d->complement, d->shift), d->sent);
+		}
 	}
 }
 
@@ -424,12 +444,14 @@ void FileTransferHandler::ft_bytesWritten(qint64 x)
 		//printf("%d bytes written\n", x);
 		d->sent += x;
 		if(d->sent == d->fileSize) {
-			d->f.close();
+			closeReader();
 			delete d->ft;
 			d->ft = 0;
 		}
-		else
+		else if(!d->sendScheduled) {
+			d->sendScheduled = true;
 			QTimer::singleShot(0, this, SLOT(trySend()));
+		}
 		progress(calcProgressStep(d->sent, d->complement, d->shift), d->sent);
 	}
 }
@@ -438,6 +460,9 @@ void FileTransferHandler::ft_error(int x)
 {
 	if(d->f.isOpen())
 		d->f.close();
+	closeReader();
+	// keep what was received, it can be resumed
+	closeWriter();
 	delete d->ft;
 	d->ft = 0;
 
@@ -455,6 +480,8 @@ void FileTransferHandler::ft_error(int x)
 
 void FileTransferHandler::trySend()
 {
+	d->sendScheduled = false;
+
 	// Since trySend comes from singleShot which is an "uncancelable"
 	//   action, we should protect that d->ft is valid, for good measure
 	if(!d->ft)
@@ -472,27 +499,101 @@ void FileTransferHandler::trySend()
 	if(!d->ft->bsConnection())
 		return;
 
-	int blockSize = d->ft->dataSizeNeeded();
-	QByteArray a(blockSize, 0);
-	int r = 0;
-	if(blockSize > 0)
-		r = d->f.read(a.data(), a.size());
-	if(r < 0) {
-		d->f.close();
+	if(!d->reader)
+		return;
+
+	// pass on as many of the chunks read ahead as the connection takes.
+	// when nothing is in flight a chunk goes out even if it is bigger
+	// than asked for, so a shrinking send window can't stall us.
+	while(d->ft && d->reader->hasChunk()) {
+		int size = d->reader->nextChunkSize();
+		if(size > d->ft->dataSizeNeeded() && d->queued > d->sent)
+			break;
+		d->queued += size;
+		d->ft->writeFileData(d->reader->takeChunk());
+	}
+}
+
+void FileTransferHandler::reader_error()
+{
+	// queued, we may have closed it meanwhile
+	if(!d->reader)
+		return;
+
+	QString err = d->reader->errorString();
+	closeReader();
+	delete d->ft;
+	d->ft = 0;
+	error(ErrFile, 0, err);
+}
+
+void FileTransferHandler::writer_error()
+{
+	// queued, we may have closed it meanwhile
+	if(!d->writer)
+		return;
+
+	QString err = d->writer->errorString();
+	closeWriter();
+	delete d->ft;
+	d->ft = 0;
+	error(ErrFile, 0, err);
+}
+
+void FileTransferHandler::writer_finished()
+{
+	// queued, we may have closed it meanwhile
+	if(!d->writer)
+		return;
+
+	// the worker is done, so this doesn't block
+	bool ok = d->writer->close();
+	QString err = d->writer->errorString();
+	closeWriter();
+	if(!ok) {
 		delete d->ft;
 		d->ft = 0;
-		error(ErrFile, 0, d->f.errorString());
+		error(ErrFile, 0, err);
 		return;
 	}
-	if(r < (int)a.size())
-		a.resize(r);
-	d->ft->writeFileData(a);
+	doFinish();
+}
+
+/**
+ * Lets the writer put what it has queued on disk in the background and
+ * deletes it afterwards.
+ */
+void FileTransferHandler::closeWriter()
+{
+	if(d->writer) {
+		// it may outlive us, but not the application, whose destructor
+		// waits for the rest of the data to be written
+		disconnect(d->writer, 0, this, 0);
+		d->writer->setParent(QCoreApplication::instance());
+		connect(d->writer, SIGNAL(finished()), d->writer, SLOT(deleteLater()));
+		d->writer->finish();
+		if(!d->writer->isRunning())
+			d->writer->deleteLater();
+		d->writer = 0;
+	}
+}
+
+void FileTransferHandler::closeReader()
+{
+	if(d->reader) {
+		// deleteLater, we might be called from one of its signals
+		d->reader->close();
+		d->reader->deleteLater();
+		d->reader = 0;
+	}
 }
 
 void FileTransferHandler::doFinish()
 {
 	if(d->sent == d->fileSize) {
 		d->f.close();
+		closeReader();
+		closeWriter();
 		delete d->ft;
 		d->ft = 0;
 	}
@@ -1480,30 +1581,15 @@ public:
 	int p;
 	qlonglong sent;
 
-	int at;
-	qlonglong last[10];
-
 	TransferMapping()
 	{
 		h = 0;
-		at = 0;
 	}
 
 	~TransferMapping()
 	{
 		delete h;
 	}
-
-	void logSent()
-	{
-		// if we're at the end, shift down to make room
-		if(at == 10) {
-			for(int n = 0; n < at - 1; ++n)
-				last[n] = last[n + 1];
-			--at;
-		}
-		last[at++] = sent;
-	}
 };
 
 class FileTransDlg::Private
@@ -1513,11 +1599,13 @@ public:
 	PsiCon *psi;
 	FileTransView *lv;
 	QList<TransferMapping*> transferList;
-	QTimer t;
+	FileTransferStats stats;
+	int updateTick;
 
 	Private(FileTransDlg *_parent)
 	{
 		parent = _parent;
+		updateTick = 0;
 	}
 
 	~Private()
@@ -1578,6 +1666,15 @@ public:
 		return 0;
 	}
 
+	void removeMapping(TransferMapping *i)
+	{
+		if(!i)
+			return;
+		transferList.removeAll(i);
+		stats.remove(i->id);
+		delete i;
+	}
+
 	TransferMapping *findMapping(int id)
 	{
 		QList<TransferMapping*>::iterator it = transferList.begin();
@@ -1591,14 +1688,7 @@ public:
 	void updateProgress(TransferMapping *i, bool updateAll=true)
 	{
 		bool done = (i->p == i->h->totalSteps());
-
-		// calculate bps
-		int bps = -1;
-		if(!done && i->at >= 2) {
-			int seconds = i->at - 1;
-			qlonglong average = i->last[i->at-1] - i->last[0];
-			bps = ((int)average) / seconds;
-		}
+		int bps = done ? -1 : stats.rate(i->id);
 
 		if(done) {
 			FileTransItem *fi = findItem(i->id);
@@ -1632,10 +1722,8 @@ public:
 
 		parent->setProgress(i->id, i->p, i->h->totalSteps(), i->sent, bps, updateAll);
 
-		if(done) {
-			transferList.removeAll(i);
-			delete i;
-		}
+		if(done)
+			removeMapping(i);
 	}
 };
 
@@ -1646,7 +1734,7 @@ FileTransDlg::FileTransDlg(PsiCon *psi)
 	d->psi = psi;
 	//d->psi->dialogRegister(this);
 
-	connect(&d->t, SIGNAL(timeout()), SLOT(updateItems()));
+	connect(&d->stats, SIGNAL(sampled()), SLOT(updateItems()));
 
 	setWindowTitle(tr("Transfer Manager"));
 #ifndef Q_OS_MAC
@@ -1703,7 +1791,6 @@ int FileTransDlg::addItem(const QString &filename, const QString &path, const QP
 
 	i->id = id;
 	i->setup();
-	d->t.start(1000);
 	return id;
 }
 
@@ -1733,8 +1820,6 @@ void FileTransDlg::removeItem(int id)
 	FileTransItem *i = d->findItem(id);
 	if(i)
 		delete i;
-	if(!d->lv->count())
-		d->t.stop();
 }
 
 void FileTransDlg::setError(int id, const QString &reason)
@@ -1766,6 +1851,7 @@ void FileTransDlg::takeTransfer(FileTransferHandler *h, int p, qlonglong sent)
 	i->p = p;
 	i->sent = sent;
 	d->transferList.append(i);
+	d->stats.add(i->id, h->fileSize(), sent);
 
 	FileTransItem *fi = d->findItem(i->id);
 	d->lv->scrollToItem(fi);
@@ -1787,9 +1873,7 @@ void FileTransDlg::clearFinished()
 		QList<FileTransItem*>::iterator it = list.begin();
 		for(; it != list.end(); ++it) {
 			FileTransItem *fi = *it;
-			TransferMapping *i = d->findMapping(fi->id);
-			d->transferList.removeAll(i);
-			delete i;
+			d->removeMapping(d->findMapping(fi->id));
 		}
 	}
 	qDeleteAll(list);
@@ -1800,18 +1884,18 @@ void FileTransDlg::ft_progress(int p, qlonglong sent)
 	TransferMapping *i = d->findMapping((FileTransferHandler *)sender());
 	i->p = p;
 	i->sent = sent;
+	d->stats.setSent(i->id, sent);
+
+	// the view is updated from updateItems(), at a fixed rate
 	if(p == i->h->totalSteps())
 		d->updateProgress(i, true);
-	else
-		d->updateProgress(i, false);
 }
 
 void FileTransDlg::ft_error(int x, int, const QString &s)
 {
 	TransferMapping *i = d->findMapping((FileTransferHandler *)sender());
 	int id = i->id;
-	d->transferList.removeAll(i);
-	delete i;
+	d->removeMapping(i);
 
 	QString str;
 	//if(x == FileTransferHandler::ErrReject)
@@ -1825,20 +1909,28 @@ void FileTransDlg::ft_error(int x, int, const QString &s)
 
 void FileTransDlg::updateItems()
 {
+	// only the progress bars move every time, the texts with the rates
+	// are refreshed once per second
+	bool updateAll = ++d->updateTick % (1000 / FileTransferStats::SampleInterval) == 0;
 	foreach (TransferMapping *i, d->transferList) {
-		if(i->h) {
-			i->logSent();
-			d->updateProgress(i);
-		}
+		if(i->h)
+			d->updateProgress(i, updateAll);
 	}
 }
 
+/**
+ * Returns statistics of the running transfers, for all of them together
+ * as well as for each by its item id.
+ */
+const FileTransferStats *FileTransDlg::stats() const
+{
+	return &d->stats;
+}
+
 void FileTransDlg::itemCancel(int id)
 {
 	FileTransItem *fi = d->findItem(id);
-	TransferMapping *i = d->findMapping(id);
-	d->transferList.removeAll(i);
-	delete i;
+	d->removeMapping(d->findMapping(id));
 	delete fi;
 }
 
@@ -1868,9 +1960,7 @@ void FileTransDlg::itemOpenDest(int id)
 void FileTransDlg::itemClear(int id)
 {
 	FileTransItem *fi = d->findItem(id);
-	TransferMapping *i = d->findMapping(id);
-	d->transferList.removeAll(i);
-	delete i;
+	d->removeMapping(d->findMapping(id));
 	delete fi;
 }
 
@@ -1893,8 +1983,7 @@ void FileTransDlg::killTransfers(PsiAccount *pa)
 		// this account?
 		if((*it)->h->account() == pa) {
 			FileTransItem *fi = d->findItem((*it)->id);
-			d->transferList.removeAll(*it);
-			delete *it;
+			d->removeMapping(*it);
 			delete fi;
 		}
 	}
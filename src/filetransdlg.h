@@ -10,6 +10,7 @@ class PsiCon;
 class PsiAccount;
 class QPixmap;
 class FileTransView;
+class FileTransferStats;
 namespace XMPP {
 	class FileTransfer;
 	class Jid;
@@ -67,12 +68,17 @@ private slots:
 	void ft_error(int);
 	void trySend();
 	void doFinish();
+	void reader_error();
+	void writer_error();
+	void writer_finished();
 
 private:
 	class Private;
 	Private *d;
 
 	void mapSignals();
+	void closeReader();
+	void closeWriter();
 };
 
 class FileRequestDlg : public QDialog, public Ui::FileTrans
@@ -125,6 +131,8 @@ public:
 	void takeTransfer(FileTransferHandler *h, int p, qlonglong sent);
 	void killTransfers(PsiAccount *pa);
 
+	const FileTransferStats *stats() const;
+
 private slots:
 	void clearFinished();
 	void ft_progress(int p, qlonglong sent);
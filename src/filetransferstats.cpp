@@ -0,0 +1,190 @@
+/*
+ * filetransferstats.cpp - samples progress and rates of file transfers
+ * Copyright (C) 2026  Psi Team
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#include "filetransferstats.h"
+
+#include <limits.h>
+
+/**
+ * \class FileTransferStats
+ * \brief Aggregates progress of running file transfers
+ *
+ * Transfers report their progress with setSent() as often as they like,
+ * which is only recorded. Every SampleInterval msecs the rates are
+ * updated, as an exponential moving average, and sampled() is emitted,
+ * so the views showing them are updated at a fixed rate no matter how
+ * many transfers run or how often they report.
+ *
+ * Rates are in bytes per second and times in seconds, -1 means not known
+ * (yet).
+ */
+FileTransferStats::FileTransferStats(QObject *parent)
+	: QObject(parent)
+	, lastSample_(0)
+{
+	clock_.start();
+	timer_.setInterval(SampleInterval);
+	connect(&timer_, SIGNAL(timeout()), SLOT(sample()));
+}
+
+void FileTransferStats::add(int id, qlonglong size, qlonglong sent)
+{
+	Transfer t;
+	t.size = size;
+	t.sent = t.sampledSent = t.startSent = sent;
+	t.started = t.lastData = clock_.elapsed();
+	t.rate = 0;
+	transfers_.insert(id, t);
+
+	if (!timer_.isActive()) {
+		lastSample_ = clock_.elapsed();
+		timer_.start();
+	}
+}
+
+void FileTransferStats::setSent(int id, qlonglong sent)
+{
+	QHash<int, Transfer>::iterator it = transfers_.find(id);
+	if (it != transfers_.end())
+		it->sent = sent;
+}
+
+void FileTransferStats::remove(int id)
+{
+	transfers_.remove(id);
+	if (transfers_.isEmpty())
+		timer_.stop();
+}
+
+bool FileTransferStats::contains(int id) const
+{
+	return transfers_.contains(id);
+}
+
+int FileTransferStats::count() const
+{
+	return transfers_.count();
+}
+
+qlonglong FileTransferStats::size(int id) const
+{
+	return transfers_.value(id).size;
+}
+
+qlonglong FileTransferStats::sent(int id) const
+{
+	return transfers_.value(id).sent;
+}
+
+int FileTransferStats::rate(int id) const
+{
+	QHash<int, Transfer>::const_iterator it = transfers_.find(id);
+	return it != transfers_.end() ? rate(*it) : -1;
+}
+
+int FileTransferStats::timeRemaining(int id) const
+{
+	QHash<int, Transfer>::const_iterator it = transfers_.find(id);
+	if (it == transfers_.end())
+		return -1;
+	return timeRemaining(it->size - it->sent, rate(*it));
+}
+
+qlonglong FileTransferStats::totalSize() const
+{
+	qlonglong size = 0;
+	foreach(const Transfer &t, transfers_)
+		size += t.size;
+	return size;
+}
+
+qlonglong FileTransferStats::totalSent() const
+{
+	qlonglong sent = 0;
+	foreach(const Transfer &t, transfers_)
+		sent += t.sent;
+	return sent;
+}
+
+/**
+ * Returns the sum of the rates known so far, or -1 if none is.
+ */
+int FileTransferStats::totalRate() const
+{
+	int total = -1;
+	foreach(const Transfer &t, transfers_) {
+		int r = rate(t);
+		if (r != -1)
+			total = qMax(total, 0) + r;
+	}
+	return total;
+}
+
+int FileTransferStats::totalTimeRemaining() const
+{
+	return timeRemaining(totalSize() - totalSent(), totalRate());
+}
+
+int FileTransferStats::rate(const Transfer &t) const
+{
+	qint64 now = clock_.elapsed();
+	if (now - t.started < WarmupTime)
+		return -1;
+	if (now - t.lastData >= StallTime)
+		return 0;
+	return (int)t.rate;
+}
+
+int FileTransferStats::timeRemaining(qlonglong left, int rate)
+{
+	if (rate <= 0)
+		return -1;
+	return (int)qMin(left / rate, (qlonglong)INT_MAX);
+}
+
+void FileTransferStats::sample()
+{
+	qint64 now = clock_.elapsed();
+	int dt = int(now - lastSample_);
+	if (dt <= 0)
+		return;
+	lastSample_ = now;
+
+	// weight of the new sample, for a time constant of SmoothingTime
+	double alpha = (double)dt / (SmoothingTime + dt);
+
+	QHash<int, Transfer>::iterator it = transfers_.begin();
+	for (; it != transfers_.end(); ++it) {
+		qlonglong delta = it->sent - it->sampledSent;
+		it->sampledSent = it->sent;
+		if (delta > 0)
+			it->lastData = now;
+
+		// start from the plain average, it takes a while for the moving
+		// one to get anywhere
+		qint64 age = now - it->started;
+		if (age < WarmupTime && age > 0)
+			it->rate = (it->sent - it->startSent) * 1000.0 / age;
+		else
+			it->rate += alpha * (delta * 1000.0 / dt - it->rate);
+	}
+
+	emit sampled();
+}
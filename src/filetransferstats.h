@@ -0,0 +1,83 @@
+/*
+ * filetransferstats.h - samples progress and rates of file transfers
+ * Copyright (C) 2026  Psi Team
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#ifndef FILETRANSFERSTATS_H
+#define FILETRANSFERSTATS_H
+
+#include <QObject>
+#include <QHash>
+#include <QTimer>
+#include <QElapsedTimer>
+
+class FileTransferStats : public QObject
+{
+	Q_OBJECT
+public:
+	enum {
+		SampleInterval = 100, // msecs, i.e. 10 updates per second
+		SmoothingTime = 2000, // time constant of the rate average
+		WarmupTime = 1000,    // no rate is reported before this
+		StallTime = 3000      // rate drops to 0 without data for this long
+	};
+
+	FileTransferStats(QObject *parent = 0);
+
+	void add(int id, qlonglong size, qlonglong sent);
+	void setSent(int id, qlonglong sent);
+	void remove(int id);
+	bool contains(int id) const;
+	int count() const;
+
+	qlonglong size(int id) const;
+	qlonglong sent(int id) const;
+	int rate(int id) const;
+	int timeRemaining(int id) const;
+
+	qlonglong totalSize() const;
+	qlonglong totalSent() const;
+	int totalRate() const;
+	int totalTimeRemaining() const;
+
+signals:
+	void sampled();
+
+private slots:
+	void sample();
+
+private:
+	struct Transfer {
+		qlonglong size, sent;
+		qlonglong startSent;   // sent as of add()
+		qlonglong sampledSent; // sent as of the last sample
+		qint64 started;        // clock time of add()
+		qint64 lastData;       // clock time of the last sample with data
+		double rate;           // smoothed, in bytes per second
+	};
+
+	static int timeRemaining(qlonglong left, int rate);
+	int rate(const Transfer &t) const;
+
+	QHash<int, Transfer> transfers_;
+	QTimer timer_;
+	QElapsedTimer clock_;
+	qint64 lastSample_;
+};
+
+#endif
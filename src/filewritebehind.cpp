@@ -0,0 +1,218 @@
+/*
+ * filewritebehind.cpp - writes a file behind its producer on a worker thread
+ * Copyright (C) 2026  Psi Team
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#include "filewritebehind.h"
+
+#include <QFile>
+#include <QList>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QWaitCondition>
+
+#ifdef Q_OS_LINUX
+#include <fcntl.h>
+#endif
+
+class FileWriteBehind::Private
+{
+public:
+	QFile file;
+	qlonglong pos;
+
+	// guarded by mutex
+	QMutex mutex;
+	QWaitCondition wake;     // for the worker
+	QWaitCondition notFull;  // for write()
+	QList<QByteArray> queue;
+	int pending;             // bytes in queue
+	bool finishing, failed;
+	QString errorString;
+
+	// only touched by the worker
+	QByteArray buffer;
+};
+
+/**
+ * \class FileWriteBehind
+ * \brief Writes a file on a worker thread in large, aligned blocks
+ *
+ * write() only queues the data (without copying it) and returns, the
+ * worker collects at least WriteSize bytes before writing. Writes are cut
+ * at multiples of Alignment in the file, only the last one may end
+ * elsewhere.
+ *
+ * The producer can't be held back from here: iris has no way to pause a
+ * FileTransfer, whatever the bytestream. So write() doesn't wait for the
+ * disk as long as less than MaxPending bytes are queued, and blocks
+ * above that to keep memory use bounded. The limit is high enough that
+ * only a disk far slower than the network ever reaches it.
+ *
+ * finish() lets the worker write out the rest and stop, QThread's
+ * finished() tells when it's done. error() is emitted if writing fails,
+ * further data is dropped then.
+ */
+FileWriteBehind::FileWriteBehind(QObject *parent)
+	: QThread(parent)
+{
+	d = new Private;
+	d->pos = 0;
+	d->pending = 0;
+	d->finishing = d->failed = false;
+}
+
+FileWriteBehind::~FileWriteBehind()
+{
+	close();
+	delete d;
+}
+
+/**
+ * Opens \a fileName for writing at \a offset, truncating it if \a offset
+ * is 0, and starts the worker. If \a preallocate is set, disk space for
+ * that many bytes is reserved where supported, without changing the
+ * size of the file, so a partial download still resumes from its end.
+ */
+bool FileWriteBehind::open(const QString &fileName, qlonglong offset, qlonglong preallocate)
+{
+	close();
+
+	QIODevice::OpenMode m = QIODevice::ReadWrite | QIODevice::Unbuffered;
+	if (offset == 0)
+		m |= QIODevice::Truncate;
+	d->file.setFileName(fileName);
+	if (!d->file.open(m) || (offset && !d->file.seek(offset))) {
+		d->errorString = d->file.errorString();
+		d->file.close();
+		return false;
+	}
+
+#if defined(Q_OS_LINUX) && defined(FALLOC_FL_KEEP_SIZE)
+	if (preallocate > offset)
+		fallocate(d->file.handle(), FALLOC_FL_KEEP_SIZE, offset, preallocate - offset);
+#else
+	Q_UNUSED(preallocate);
+#endif
+
+	d->pos = offset;
+	d->queue.clear();
+	d->pending = 0;
+	d->finishing = d->failed = false;
+	d->errorString = QString();
+	d->buffer.clear();
+	d->buffer.reserve(WriteSize + Alignment);
+	start();
+	return true;
+}
+
+/**
+ * Queues \a data to be appended to the file.
+ */
+void FileWriteBehind::write(const QByteArray &data)
+{
+	QMutexLocker locker(&d->mutex);
+	if (d->failed || d->finishing || !d->file.isOpen() || data.isEmpty())
+		return;
+
+	while (d->pending >= MaxPending && !d->failed)
+		d->notFull.wait(&d->mutex);
+
+	d->queue += data;
+	d->pending += data.size();
+	if (d->pending >= WriteSize)
+		d->wake.wakeOne();
+}
+
+/**
+ * Lets the worker write everything queued and stop, without waiting for
+ * it. Nothing can be written afterwards.
+ */
+void FileWriteBehind::finish()
+{
+	QMutexLocker locker(&d->mutex);
+	d->finishing = true;
+	d->wake.wakeOne();
+}
+
+/**
+ * Writes everything queued, stops the worker and closes the file.
+ * Returns false if any write failed. This blocks until the data is on
+ * disk, unless finish() was called and finished() emitted before.
+ */
+bool FileWriteBehind::close()
+{
+	if (!d->file.isOpen())
+		return !d->failed;
+
+	finish();
+	wait();
+
+	d->file.close();
+	d->buffer.clear();
+	return !d->failed;
+}
+
+QString FileWriteBehind::errorString() const
+{
+	QMutexLocker locker(&d->mutex);
+	return d->errorString;
+}
+
+void FileWriteBehind::run()
+{
+	bool last = false;
+	while (!last) {
+		d->mutex.lock();
+		while (!d->finishing && d->pending < WriteSize)
+			d->wake.wait(&d->mutex);
+		QList<QByteArray> queue = d->queue;
+		d->queue.clear();
+		d->pending = 0;
+		last = d->finishing;
+		d->notFull.wakeAll();
+		d->mutex.unlock();
+
+		foreach(const QByteArray &data, queue)
+			d->buffer += data;
+		queue.clear();
+
+		// keep the tail which doesn't reach the next aligned offset
+		// for later, unless this is the end
+		int size = d->buffer.size();
+		if (!last)
+			size -= (int)((d->pos + size) % Alignment);
+		if (size <= 0)
+			continue;
+
+		qint64 r = d->file.write(d->buffer.constData(), size);
+		if (r != size) {
+			d->mutex.lock();
+			d->failed = true;
+			d->errorString = d->file.errorString();
+			d->queue.clear();
+			d->pending = 0;
+			d->notFull.wakeAll();
+			d->mutex.unlock();
+			emit error();
+			break;
+		}
+		d->pos += size;
+		d->buffer.remove(0, size);
+	}
+}
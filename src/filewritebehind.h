@@ -0,0 +1,58 @@
+/*
+ * filewritebehind.h - writes a file behind its producer on a worker thread
+ * Copyright (C) 2026  Psi Team
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#ifndef FILEWRITEBEHIND_H
+#define FILEWRITEBEHIND_H
+
+#include <QThread>
+#include <QByteArray>
+
+class FileWriteBehind : public QThread
+{
+	Q_OBJECT
+public:
+	enum {
+		WriteSize = 262144,   // data collected before it goes to disk
+		Alignment = 65536,    // writes end at multiples of this offset
+		MaxPending = 33554432 // write() blocks above this
+	};
+
+	FileWriteBehind(QObject *parent = 0);
+	~FileWriteBehind();
+
+	bool open(const QString &fileName, qlonglong offset, qlonglong preallocate = 0);
+	void write(const QByteArray &data);
+	void finish();
+	bool close();
+	QString errorString() const;
+
+signals:
+	void error();
+
+protected:
+	// reimplemented
+	void run();
+
+private:
+	class Private;
+	Private *d;
+};
+
+#endif
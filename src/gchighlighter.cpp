@@ -0,0 +1,213 @@
+/*
+ * gchighlighter.cpp - highlight word and nick color matching for groupchats
+ * Copyright (C) 2026  Psi Team
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#include "gchighlighter.h"
+
+#include "psioptions.h"
+
+/**
+ * \class GCHighlighter
+ * \brief Decides which groupchat messages mention the user
+ *
+ * Own nick and the highlight words from the options are compiled into a
+ * single automaton, so a message body is scanned once no matter how many
+ * words there are. The nick is matched case sensitively, the highlight
+ * words are not. The relevant options, including the nick color table,
+ * are cached and only re-read when they change.
+ */
+GCHighlighter::GCHighlighter(QObject *parent)
+	: QObject(parent)
+	, dirty_(true)
+{
+	readHighlightOptions();
+	readColorOptions();
+	connect(PsiOptions::instance(), SIGNAL(optionChanged(const QString&)), SLOT(optionChanged(const QString&)));
+}
+
+void GCHighlighter::setNick(const QString &nick)
+{
+	if (nick == nick_)
+		return;
+	nick_ = nick;
+	dirty_ = true;
+}
+
+/**
+ * Returns value of options.ui.muc.use-highlighting. match() doesn't
+ * look for highlight words when it is disabled.
+ */
+bool GCHighlighter::highlightingEnabled() const
+{
+	return useHighlighting_;
+}
+
+/**
+ * Scans \a text once and reports whether it mentions own nick and
+ * whether it contains any of the highlight words.
+ */
+GCHighlighter::Matches GCHighlighter::match(const QString &text)
+{
+	if (dirty_)
+		compile();
+
+	Matches result = NoMatch;
+	if (patterns_.isEmpty())
+		return result;
+
+	int state = 0;
+	const QChar *chars = text.unicode();
+	for (int i = 0; i < text.length(); ++i) {
+		ushort c = chars[i].toCaseFolded().unicode();
+		while (state && !states_[state].next.contains(c))
+			state = states_[state].fail;
+		state = states_[state].next.value(c, 0);
+
+		foreach(int n, states_[state].patterns) {
+			const Pattern &p = patterns_[n];
+			if (result & p.match)
+				continue;
+			if (p.caseSensitive &&
+			    QStringRef(&text, i - p.text.length() + 1, p.text.length()) != p.text)
+			{
+				continue;
+			}
+			result |= p.match;
+		}
+
+		if (result == allMatches_)
+			break;
+	}
+	return result;
+}
+
+/**
+ * Returns the color for the \a sender'th nick seen in the room, -1 being
+ * own nick.
+ */
+QString GCHighlighter::nickColor(int sender) const
+{
+	if (!useNickColoring_ || nickColors_.isEmpty()) {
+		return "#000000";
+	}
+	else if (sender == -1 || nickColors_.size() == 1) {
+		return nickColors_.last();
+	}
+	else {
+		int n = sender % (nickColors_.size() - 1);
+		return nickColors_[n];
+	}
+}
+
+void GCHighlighter::optionChanged(const QString &option)
+{
+	if (option == "options.ui.muc.highlight-words" ||
+	    option == "options.ui.muc.use-highlighting")
+	{
+		readHighlightOptions();
+	}
+	else if (option == "options.ui.muc.use-nick-coloring" ||
+	         option == "options.ui.look.colors.muc.nick-colors")
+	{
+		readColorOptions();
+	}
+}
+
+void GCHighlighter::readHighlightOptions()
+{
+	PsiOptions *o = PsiOptions::instance();
+	words_ = o->getOption("options.ui.muc.highlight-words").toStringList();
+	useHighlighting_ = o->getOption("options.ui.muc.use-highlighting").toBool();
+	dirty_ = true;
+}
+
+void GCHighlighter::readColorOptions()
+{
+	PsiOptions *o = PsiOptions::instance();
+	useNickColoring_ = o->getOption("options.ui.muc.use-nick-coloring").toBool();
+	nickColors_ = o->getOption("options.ui.look.colors.muc.nick-colors").toStringList();
+}
+
+void GCHighlighter::compile()
+{
+	dirty_ = false;
+	allMatches_ = NoMatch;
+	patterns_.clear();
+	states_.clear();
+
+	// empty patterns would match everything
+	if (!nick_.isEmpty()) {
+		Pattern p;
+		p.text = nick_;
+		p.caseSensitive = true;
+		p.match = MentionsNick;
+		patterns_ += p;
+	}
+	if (useHighlighting_) {
+		foreach(const QString &word, words_) {
+			if (word.isEmpty())
+				continue;
+			Pattern p;
+			p.text = word;
+			p.caseSensitive = false;
+			p.match = Highlighted;
+			patterns_ += p;
+		}
+	}
+
+	// trie of the case folded patterns
+	states_.append(State());
+	for (int n = 0; n < patterns_.count(); ++n) {
+		allMatches_ |= patterns_[n].match;
+		QString folded = patterns_[n].text.toCaseFolded();
+		int state = 0;
+		for (int i = 0; i < folded.length(); ++i) {
+			ushort c = folded[i].unicode();
+			int next = states_[state].next.value(c, 0);
+			if (!next) {
+				next = states_.count();
+				states_.append(State());
+				states_[state].next.insert(c, next);
+			}
+			state = next;
+		}
+		states_[state].patterns += n;
+	}
+
+	// failure links, breadth first so that the shallower states are done
+	QList<int> queue;
+	foreach(int child, states_[0].next)
+		queue += child;
+	while (!queue.isEmpty()) {
+		int state = queue.takeFirst();
+		QHash<ushort, int>::const_iterator it = states_[state].next.constBegin();
+		for (; it != states_[state].next.constEnd(); ++it) {
+			int child = it.value();
+			int fail = states_[state].fail;
+			while (fail && !states_[fail].next.contains(it.key()))
+				fail = states_[fail].fail;
+			fail = states_[fail].next.value(it.key(), 0);
+			if (fail == child)
+				fail = 0;
+			states_[child].fail = fail;
+			states_[child].patterns += states_[fail].patterns;
+			queue += child;
+		}
+	}
+}
@@ -0,0 +1,87 @@
+/*
+ * gchighlighter.h - highlight word and nick color matching for groupchats
+ * Copyright (C) 2026  Psi Team
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#ifndef GCHIGHLIGHTER_H
+#define GCHIGHLIGHTER_H
+
+#include <QObject>
+#include <QHash>
+#include <QList>
+#include <QStringList>
+#include <QVector>
+
+class GCHighlighter : public QObject
+{
+	Q_OBJECT
+public:
+	enum Match {
+		NoMatch      = 0x0,
+		MentionsNick = 0x1, // own nick occurs in the text
+		Highlighted  = 0x2  // one of the highlight words occurs in the text
+	};
+	Q_DECLARE_FLAGS(Matches, Match)
+
+	GCHighlighter(QObject *parent = 0);
+
+	void setNick(const QString &nick);
+
+	bool highlightingEnabled() const;
+	Matches match(const QString &text);
+
+	QString nickColor(int sender) const;
+
+private slots:
+	void optionChanged(const QString &option);
+
+private:
+	// Aho-Corasick automaton over case folded text
+	struct State {
+		State() : fail(0) {}
+		QHash<ushort, int> next;
+		int fail;
+		QList<int> patterns; // indexes into patterns_, including via fail
+	};
+
+	struct Pattern {
+		QString text;
+		bool caseSensitive;
+		Match match;
+	};
+
+	void readHighlightOptions();
+	void readColorOptions();
+	void compile();
+
+	QString nick_;
+	QStringList words_;
+	bool useHighlighting_;
+
+	bool useNickColoring_;
+	QStringList nickColors_;
+
+	bool dirty_;
+	Matches allMatches_;
+	QList<Pattern> patterns_;
+	QVector<State> states_;
+};
+
+Q_DECLARE_OPERATORS_FOR_FLAGS(GCHighlighter::Matches)
+
+#endif
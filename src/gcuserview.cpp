@@ -37,11 +37,6 @@
 #include "psioptions.h"
 #include "coloropt.h"
 
-static bool caseInsensitiveLessThan(const QString &s1, const QString &s2)
-{
-	return s1.toLower() < s2.toLower();
-}
-
 
 //----------------------------------------------------------------------------
 // GCUserViewDelegate
@@ -213,6 +208,8 @@ void GCUserView::clear()
 		GCUserViewGroupItem *j = (GCUserViewGroupItem*)topLevelItem(num);
 		qDeleteAll(j->takeChildren());
 	}
+	items_.clear();
+	nickIndex_.clear();
 }
 
 void GCUserView::updateAll()
@@ -229,22 +226,38 @@ void GCUserView::updateAll()
 	}
 }
 
+/**
+ * Returns nicks of all occupants, sorted case insensitively.
+ */
 QStringList GCUserView::nickList() const
+{
+	return nickIndex_.values();
+}
+
+/**
+ * Returns nicks starting with \a prefix (compared case insensitively),
+ * sorted the same way as nickList().
+ */
+QStringList GCUserView::nicksStartingWith(const QString &prefix) const
 {
 	QStringList list;
+	QString folded = prefix.toCaseFolded();
+	QMultiMap<QString, QString>::const_iterator it = nickIndex_.lowerBound(folded);
+	for (; it != nickIndex_.constEnd() && it.key().startsWith(folded); ++it)
+		list << it.value();
+	return list;
+}
 
-	int topCount = topLevelItemCount();
-	for(int num = 0; num < topCount; num++) {
-		GCUserViewGroupItem *j = (GCUserViewGroupItem*)topLevelItem(num);
-		int count = j->childCount();
-		for(int num = 0; num < count; num++) {
-			QTreeWidgetItem *lvi = j->child(num);
-			list << lvi->text(0);
-		}
-	}
+void GCUserView::addToIndex(const QString &nick, GCUserViewItem *item)
+{
+	items_.insert(nick, item);
+	nickIndex_.insert(nick.toCaseFolded(), nick);
+}
 
-	qSort(list.begin(), list.end(), caseInsensitiveLessThan);
-	return list;
+void GCUserView::removeFromIndex(const QString &nick)
+{
+	items_.remove(nick);
+	nickIndex_.remove(nick.toCaseFolded(), nick);
 }
 
 bool GCUserView::hasJid(const Jid& jid)
@@ -265,18 +278,7 @@ bool GCUserView::hasJid(const Jid& jid)
 
 QTreeWidgetItem *GCUserView::findEntry(const QString &nick)
 {
-	int topCount = topLevelItemCount();
-	for(int num = 0; num < topCount; num++) {
-		GCUserViewGroupItem *j = (GCUserViewGroupItem*)topLevelItem(num);
-		int count = j->childCount();
-		for(int num = 0; num < count; num++) {
-			QTreeWidgetItem *lvi = j->child(num);
-			if(lvi->text(0) == nick)
-				return lvi;
-		}
-	}
-
-	return 0;
+	return items_.value(nick);
 }
 
 QTreeWidgetItem *GCUserView::findEntry(const QModelIndex &index)
@@ -290,6 +292,7 @@ void GCUserView::updateEntry(const QString &nick, const Status &s)
 	GCUserViewItem *lvi = (GCUserViewItem *)findEntry(nick);
 	if (lvi && lvi->s.mucItem().role() != s.mucItem().role()) {
 		gr = findGroup(lvi->s.mucItem().role());
+		removeFromIndex(nick);
 		delete lvi;
 		gr->updateText();
 		lvi = NULL;
@@ -299,6 +302,7 @@ void GCUserView::updateEntry(const QString &nick, const Status &s)
 	if(!lvi) {
 		lvi = new GCUserViewItem(gr);
 		lvi->setText(0, nick);
+		addToIndex(nick, lvi);
 		gr->updateText();
 	}
 
@@ -330,6 +334,7 @@ void GCUserView::removeEntry(const QString &nick)
 	GCUserViewItem *lvi = (GCUserViewItem *)findEntry(nick);
 	if(lvi) {
 		GCUserViewGroupItem* gr = findGroup(lvi->s.mucItem().role());
+		removeFromIndex(nick);
 		delete lvi;
 		gr->updateText();
 	}
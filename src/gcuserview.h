@@ -23,6 +23,8 @@
 #define GCUSERVIEW_H
 
 #include <QTreeWidget>
+#include <QHash>
+#include <QMultiMap>
 
 #include "xmpp_status.h"
 
@@ -75,6 +77,7 @@ public:
 	void updateEntry(const QString &, const Status &);
 	void removeEntry(const QString &);
 	QStringList nickList() const;
+	QStringList nicksStartingWith(const QString &prefix) const;
 
 protected:
 	enum Role { Moderator = 0, Participant = 1, Visitor = 2 };
@@ -93,8 +96,14 @@ private slots:
 
 private:
 	void contextMenuRequested(const QPoint& p);
+	void addToIndex(const QString &nick, GCUserViewItem *item);
+	void removeFromIndex(const QString &nick);
 
 	GCMainDlg* gcDlg_;
+
+	// occupants by nick, and nicks sorted by their case folded form
+	QHash<QString, GCUserViewItem*> items_;
+	QMultiMap<QString, QString> nickIndex_;
 };
 
 #endif
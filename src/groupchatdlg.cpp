@@ -82,6 +82,7 @@
 #include "mcmdsimplesite.h"
 
 #include "tabcompletion.h"
+#include "gchighlighter.h"
 
 #ifdef Q_OS_WIN
 #include <windows.h>
@@ -190,6 +191,8 @@ public:
 		trackBar = false;
 		oldTrackBarPosition = 0;
 		mCmdManager.registerProvider(this);
+
+		highlighter = new GCHighlighter(this);
 	}
 
 	GCMainDlg *dlg;
@@ -197,6 +200,7 @@ public:
 	MUCManager *mucManager;
 	QString self, prev_self;
 	QString password;
+	GCHighlighter *highlighter;
 	bool nonAnonymous;		 // got status code 100 ?
 	IconAction *act_find, *act_clear, *act_icon, *act_configure;
 #ifdef WHITEBOARDING
@@ -246,6 +250,7 @@ public slots:
 
 	void deferredScroll() {
 		//QTimer::singleShot(250, this, SLOT(slotScroll()));
+		te_log()->flushQueuedText();
 		te_log()->scrollToBottom();
 	}
 
@@ -417,7 +422,7 @@ join <channel>{,<channel>} [pass{,<pass>}
 			if (item == 0) {
 				all << "clear" + spaceAtEnd << "nick" + spaceAtEnd << "sping" + spaceAtEnd << "version" + spaceAtEnd << "idle" + spaceAtEnd << "quote" + spaceAtEnd;
 			} else if (item == 1 && (partcommand[0] == "version" || partcommand[0] == "idle")) {
-				all = dlg->ui_.lv_users->nickList();
+				all = dlg->ui_.lv_users->nicksStartingWith(query);
 			}
 		}
 		QStringList res;
@@ -487,6 +492,9 @@ public:
 	{
 		trackBar = false;
 
+		// the bar goes below everything received so far
+		te_log()->flushQueuedText();
+
 		// save position, because our manipulations could change it
 		int scrollbarValue = te_log()->verticalScrollBar()->value();
 
@@ -580,14 +588,12 @@ public:
 			if (p_->mCmdSite.isActive()) {
 				return mCmdList_;
 			}
-			QStringList suggestedNicks;
-			QStringList nicks = allNicks();
+			QStringList suggestedNicks = p_->byRecency(p_->dlg->ui_.lv_users->nicksStartingWith(toComplete_));
 
-			QString postAdd = atStart_ ? nickSeparator + " " : "";
-
-			foreach(QString nick, nicks) {
-				if (nick.left(toComplete_.length()).toLower() == toComplete_.toLower()) {
-					suggestedNicks << nick + postAdd;
+			if (atStart_) {
+				QStringList::Iterator it = suggestedNicks.begin();
+				for ( ; it != suggestedNicks.end(); ++it) {
+					*it = *it + nickSeparator + " ";
 				}
 			}
 			return suggestedNicks;
@@ -603,7 +609,7 @@ public:
 				guess += nickSeparator + " ";
 			}
 
-			QStringList all = allNicks();
+			QStringList all = p_->byRecency(allNicks());
 
 			if (atStart_) {
 				QStringList::Iterator it = all.begin();
@@ -626,6 +632,49 @@ public:
 
 	TabCompletionMUC tabCompletion;
 
+	// most recent first
+	QStringList recentSpeakers;
+	enum { MAXRECENTSPEAKERS = 32 };
+
+	void noteSpeaker(const QString &nick)
+	{
+		recentSpeakers.removeOne(nick);
+		recentSpeakers.prepend(nick);
+		if (recentSpeakers.count() > MAXRECENTSPEAKERS)
+			recentSpeakers.removeLast();
+	}
+
+	void renameSpeaker(const QString &oldNick, const QString &newNick)
+	{
+		int i = recentSpeakers.indexOf(oldNick);
+		if (i != -1)
+			recentSpeakers[i] = newNick;
+	}
+
+	/**
+	 * Moves those of the sorted \a nicks who spoke recently to the front,
+	 * most recent first.
+	 */
+	QStringList byRecency(const QStringList &nicks) const
+	{
+		if (nicks.count() < 2)
+			return nicks;
+
+		QStringList recent;
+		foreach(const QString &nick, recentSpeakers) {
+			if (nicks.contains(nick))
+				recent += nick;
+		}
+		if (recent.isEmpty())
+			return nicks;
+
+		QStringList result = recent;
+		foreach(const QString &nick, nicks) {
+			if (!recent.contains(nick))
+				result += nick;
+		}
+		return result;
+	}
 };
 
 GCMainDlg::GCMainDlg(PsiAccount *pa, const Jid &j, TabManager *tabManager)
@@ -1373,6 +1422,9 @@ void GCMainDlg::presence(const QString &nick, const Status &s)
 			suppressDefault = true;
 		}
 
+		if (s.getMUCStatuses().contains(303))
+			d->renameSpeaker(nick, s.mucItem().nick());
+
 		if ( !d->connecting && !suppressDefault && options_->getOption("options.muc.show-joins").toBool() ) {
 			if (s.getMUCStatuses().contains(303)) {
 				message = tr("%1 is now known as %2").arg(nick).arg(s.mucItem().nick());
@@ -1433,20 +1485,15 @@ void GCMainDlg::message(const Message &_m)
 		return;
 
 	// code to determine if the speaker was addressing this client in chat
-	if(m.body().contains(d->self))
+	d->highlighter->setNick(d->self);
+	if(d->highlighter->match(m.body()) != GCHighlighter::NoMatch)
 		alert = true;
 
-	if (m.body().left(d->self.length()) == d->self)
+	if (m.body().startsWith(d->self))
 		d->lastReferrer = m.from().resource();
 
-	if(PsiOptions::instance()->getOption("options.ui.muc.use-highlighting").toBool()) {
-		QStringList highlightWords = PsiOptions::instance()->getOption("options.ui.muc.highlight-words").toStringList();
-		foreach (QString word, highlightWords) {
-			if(m.body().contains((word), Qt::CaseInsensitive)) {
-				alert = true;
-			}
-		}
-	}
+	if (!from.isEmpty() && from != d->self)
+		d->noteSpeaker(from);
 
 	// play sound?
 	if(from == d->self) {
@@ -1492,7 +1539,7 @@ void GCMainDlg::updateLastMsgTime(QDateTime t)
 	lastMsgTime_ = t;
 	if (doInsert) {
 		QString color = ColorOpt::instance()->color("options.ui.look.colors.messages.informational").name();
-		ui_.log->appendText(QString("<font color=\"%1\">*** %2</font>").arg(color).arg(t.date().toString(Qt::ISODate)));
+		ui_.log->queueText(QString("<font color=\"%1\">*** %2</font>").arg(color).arg(t.date().toString(Qt::ISODate)));
 	}
 }
 
@@ -1510,7 +1557,7 @@ void GCMainDlg::appendSysMsg(const QString &str, bool alert, const QDateTime &ts
 	if (d->trackBar)
 		d->doTrackBar();
 
-	if (!PsiOptions::instance()->getOption("options.ui.muc.use-highlighting").toBool())
+	if (!d->highlighter->highlightingEnabled())
 		alert=false;
 
 	QDateTime time = QDateTime::currentDateTime();
@@ -1520,7 +1567,7 @@ void GCMainDlg::appendSysMsg(const QString &str, bool alert, const QDateTime &ts
 	updateLastMsgTime(time);
 	QString timestr = ui_.log->formatTimeStamp(time);
 	QString color = ColorOpt::instance()->color("options.ui.look.colors.messages.informational").name();
-	ui_.log->appendText(QString("<font color=\"%1\">[%2]").arg(color, timestr) +
+	ui_.log->queueText(QString("<font color=\"%1\">[%2]").arg(color, timestr) +
 		QString(" *** %1</font>").arg(prepareAsChatMessage ? TextUtil::prepareMessageText(str) : TextUtil::escape(str)));
 
 	if(alert)
@@ -1541,25 +1588,14 @@ QString GCMainDlg::getNickColor(QString nick)
 		sender=nicks[nick];
 	}
 
-	QStringList nickColors = PsiOptions::instance()->getOption("options.ui.look.colors.muc.nick-colors").toStringList();
-
-	if(!PsiOptions::instance()->getOption("options.ui.muc.use-nick-coloring").toBool() || nickColors.empty()) {
-		return "#000000";
-	}
-	else if(sender == -1 || nickColors.size() == 1) {
-		return nickColors[nickColors.size()-1];
-	}
-	else {
-		int n = sender % (nickColors.size()-1);
-		return nickColors[n];
-	}
+	return d->highlighter->nickColor(sender);
 }
 
 void GCMainDlg::appendMessage(const Message &m, bool alert)
 {
 	updateLastMsgTime(m.timeStamp());
 	//QString who, color;
-	if (!PsiOptions::instance()->getOption("options.ui.muc.use-highlighting").toBool())
+	if (!d->highlighter->highlightingEnabled())
 		alert=false;
 	QString who, textcolor, nickcolor,alerttagso,alerttagsc;
 
@@ -1604,16 +1640,16 @@ void GCMainDlg::appendMessage(const Message &m, bool alert)
 
 	if(emote) {
 		//ui_.log->append(QString("<font color=\"%1\">").arg(color) + QString("[%1]").arg(timestr) + QString(" *%1 ").arg(TextUtil::escape(who)) + txt + "</font>");
-		ui_.log->appendText(QString("<font color=\"%1\">").arg(nickcolor) + QString("[%1]").arg(timestr) + QString(" *%1 ").arg(TextUtil::escape(who)) + alerttagso + txt + alerttagsc + "</font>");
+		ui_.log->queueText(QString("<font color=\"%1\">").arg(nickcolor) + QString("[%1]").arg(timestr) + QString(" *%1 ").arg(TextUtil::escape(who)) + alerttagso + txt + alerttagsc + "</font>");
 	}
 	else {
 		if(PsiOptions::instance()->getOption("options.ui.chat.use-chat-says-style").toBool()) {
 			//ui_.log->append(QString("<font color=\"%1\">").arg(color) + QString("[%1] ").arg(timestr) + QString("%1 says:").arg(TextUtil::escape(who)) + "</font><br>" + txt);
-			ui_.log->appendText(QString("<font color=\"%1\">").arg(nickcolor) + QString("[%1] ").arg(timestr) + QString("%1 says:").arg(TextUtil::escape(who)) + "</font><br>" + QString("<font color=\"%1\">").arg(textcolor) + alerttagso + txt + alerttagsc + "</font>");
+			ui_.log->queueText(QString("<font color=\"%1\">").arg(nickcolor) + QString("[%1] ").arg(timestr) + QString("%1 says:").arg(TextUtil::escape(who)) + "</font><br>" + QString("<font color=\"%1\">").arg(textcolor) + alerttagso + txt + alerttagsc + "</font>");
 		}
 		else {
 			//ui_.log->append(QString("<font color=\"%1\">").arg(color) + QString("[%1] &lt;").arg(timestr) + TextUtil::escape(who) + QString("&gt;</font> ") + txt);
-			ui_.log->appendText(QString("<font color=\"%1\">").arg(nickcolor) + QString("[%1] &lt;").arg(timestr) + TextUtil::escape(who) + QString("&gt;</font> ") + QString("<font color=\"%1\">").arg(textcolor) + alerttagso + txt + alerttagsc +"</font>");
+			ui_.log->queueText(QString("<font color=\"%1\">").arg(nickcolor) + QString("[%1] &lt;").arg(timestr) + TextUtil::escape(who) + QString("&gt;</font> ") + QString("<font color=\"%1\">").arg(textcolor) + alerttagso + txt + alerttagsc +"</font>");
 		}
 	}
 
@@ -1673,6 +1709,8 @@ void GCMainDlg::setLooks()
 	ui_.log->setFont(f);
 	ui_.mle->chatEdit()->setFont(f);
 
+	ui_.log->setScrollbackLimit(PsiOptions::instance()->getOption("options.ui.muc.scrollback-limit").toInt());
+
 	f.fromString(PsiOptions::instance()->getOption("options.ui.look.font.contactlist").toString());
 	ui_.lv_users->setFont(f);
 
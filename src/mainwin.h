@@ -41,7 +41,6 @@ class PsiToolBar;
 class PsiAccount;
 class IconAction;
 class PsiIcon;
-class ContactView;
 class PsiTrayIcon;
 namespace XMPP {
 	class Status;
@@ -64,10 +63,6 @@ public:
 	QStringList actionList;
 	QMap<QString, QAction*> actions;
 
-#ifndef NEWCONTACTLIST
-	ContactView *cvlist;
-#endif
-
 	PsiCon *psiCon() const;
 
 protected:
@@ -136,9 +131,6 @@ private slots:
 	bool showDockMenu(const QPoint &);
 	void dockActivated();
 	
-	void searchClearClicked();
-	void searchTextEntered(QString const &text);
-	void searchTextStarted(QString const &text);
 
 	void registerAction( IconAction * );
 
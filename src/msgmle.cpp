@@ -142,7 +142,7 @@ bool ChatView::handleCopyEvent(QObject *object, QEvent *event, ChatEdit *chatEdi
 	return false;
 }
 
-void ChatView::appendText(const QString &text)
+void ChatView::appendTexts(const QStringList &texts)
 {
 	bool doScrollToBottom = atBottom();
 	
@@ -150,12 +150,12 @@ void ChatView::appendText(const QString &text)
 	// restoring selection
 	int scrollbarValue = verticalScrollBar()->value();
 	
-	PsiTextView::appendText(text);
+	int dropped = insertText(texts);
 	
 	if (doScrollToBottom)
 		scrollToBottom();
 	else
-		verticalScrollBar()->setValue(scrollbarValue);
+		verticalScrollBar()->setValue(scrollbarValue - dropped);
 }
 
 /**
@@ -188,7 +188,7 @@ ChatEdit::ChatEdit(QWidget *parent)
 
 	previous_position_ = 0;
 	setCheckSpelling(checkSpellingGloballyEnabled());
-	connect(PsiOptions::instance(),SIGNAL(optionChanged(const QString&)),SLOT(optionsChanged()));
+	PsiOptions::instance()->subscribe("options.ui.spell-check.enabled", this, SLOT(optionsChanged()));
 }
 
 ChatEdit::~ChatEdit()
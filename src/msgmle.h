@@ -44,12 +44,14 @@ public:
 	// reimplemented
 	QSize sizeHint() const;
 
-	void appendText(const QString &text);
 	bool handleCopyEvent(QObject *object, QEvent *event, ChatEdit *chatEdit);
 
 	QString formatTimeStamp(const QDateTime &time);
 
 protected:
+	// reimplemented
+	void appendTexts(const QStringList &texts);
+
 	// override the tab/esc behavior
 	bool focusNextPrevChild(bool next);
 	void keyPressEvent(QKeyEvent *);
@@ -78,9 +78,6 @@
 #endif
 #include "rosteritemexchangetask.h"
 #include "chatdlg.h"
-#ifndef NEWCONTACTLIST
-# include "contactview.h"
-#endif
 #include "mood.h"
 #include "tune.h"
 #ifdef GROUPCHAT
@@ -144,7 +141,6 @@
 #include "Certificates/CertificateHelpers.h"
 #include "Certificates/CertificateErrorDialog.h"
 #include "Certificates/CertificateDisplayDialog.h"
-#include "legacypsiaccount.h"
 #include "bookmarkmanagedlg.h"
 #include "accountloginpassword.h"
 #include "alertmanager.h"
@@ -576,6 +572,11 @@ public:
 		return pathToProfile(activeProfile, ApplicationInfo::DataLocation) + "/events-" + JIDUtil::encode(acc.id).toLower() + ".xml";
 	}
 
+	QString pathToProfileEventsJournal() const
+	{
+		return pathToProfile(activeProfile, ApplicationInfo::DataLocation) + "/events-" + JIDUtil::encode(acc.id).toLower() + ".journal";
+	}
+
 	void updateOnlineContactsCount()
 	{
 		int newOnlineContactsCount = 0;
@@ -652,21 +653,21 @@ public:
 	}
 
 public slots:
-	void queueChanged()
-	{
-		eventQueue->toFile(pathToProfileEvents());
-	}
-
 	void loadQueue()
 	{
 		bool soundEnabled = PsiOptions::instance()->getOption("options.ui.notifications.sounds.enable").toBool();
 		PsiOptions::instance()->setOption("options.ui.notifications.sounds.enable", false); // disable the sound and popups
 		doPopups_ = false;
 
+		// queues saved by older versions
 		QFileInfo fi( pathToProfileEvents() );
 		if ( fi.exists() )
 			eventQueue->fromFile(pathToProfileEvents());
 
+		eventQueue->fromJournal(pathToProfileEventsJournal());
+		if (eventQueue->setJournalFile(pathToProfileEventsJournal()) && fi.exists())
+			QFile::remove(pathToProfileEvents());
+
 		PsiOptions::instance()->setOption("options.ui.notifications.sounds.enable", soundEnabled);
 		doPopups_ = true;
 	}
@@ -949,11 +950,7 @@ public:
 
 PsiAccount* PsiAccount::create(const UserAccount &acc, PsiContactList *parent, CapsRegistry* capsRegistry, TabManager *tabManager)
 {
-#ifdef NEWCONTACTLIST
 	PsiAccount* account = new PsiAccount(acc, parent, capsRegistry, tabManager);
-#else
-	PsiAccount* account = new LegacyPsiAccount(acc, parent, capsRegistry, tabManager);
-#endif
 	account->init();
 	return account;
 }
@@ -989,7 +986,6 @@ PsiAccount::PsiAccount(const UserAccount &acc, PsiContactList *parent, CapsRegis
 
 	d->eventQueue = new EventQueue(this);
 	connect(d->eventQueue, SIGNAL(queueChanged()), SIGNAL(queueChanged()));
-	connect(d->eventQueue, SIGNAL(queueChanged()), d, SLOT(queueChanged()));
 	connect(d->eventQueue, SIGNAL(eventFromXml(PsiEvent *)), SLOT(eventFromXml(PsiEvent *)));
 	d->self = UserListItem(true);
 	d->self.setSubscription(Subscription::Both);
@@ -1500,10 +1496,18 @@ void PsiAccount::setUserAccount(const UserAccount &_acc)
 
 void PsiAccount::deleteQueueFile()
 {
-	QFileInfo fi(d->pathToProfileEvents());
-	if(fi.exists()) {
-		QDir dir = fi.dir();
-		dir.remove(fi.fileName());
+	d->eventQueue->setJournalFile(QString());
+
+	QStringList files;
+	files << d->pathToProfileEvents()
+	      << d->pathToProfileEventsJournal()
+	      << d->pathToProfileEventsJournal() + ".new";
+	foreach(const QString &file, files) {
+		QFileInfo fi(file);
+		if(fi.exists()) {
+			QDir dir = fi.dir();
+			dir.remove(fi.fileName());
+		}
 	}
 }
 
@@ -6020,11 +6024,6 @@ void PsiAccount::resetLastManualStatusSafeGuard()
 	d->setManualStatus(XMPP::Status());
 }
 
-ContactProfile *PsiAccount::contactProfile() const
-{
-	return 0;
-}
-
 bool PsiAccount::usingSSL() const
 {
 	return d->usingSSL;
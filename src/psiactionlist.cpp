@@ -79,7 +79,7 @@ PsiActionList::Private::Private(PsiActionList *_list, PsiCon *_psi)
 	createChat();
 	createGroupchat();
 
-	connect(PsiOptions::instance(), SIGNAL(optionChanged(const QString&)), SLOT(optionsChanged()));
+	PsiOptions::instance()->subscribe("options.ui.menu.status", this, SLOT(optionsChanged()));
 	optionsChanged();
 }
 
@@ -654,12 +654,25 @@ void PsiChatDlg::updateLastMsgTime(QDateTime t)
 {
 	bool doInsert = t.date() != lastMsgTime_.date();
 	lastMsgTime_ = t;
+	chatView()->setTimestamp(t);
 	if (doInsert) {
 		QString color = "#00A000";
 		chatView()->appendText(QString("<font color=\"%1\">*** %2</font>").arg(color).arg(t.date().toString(Qt::ISODate)));
 	}
 }
 
+void PsiChatDlg::historyPageAboutToBeShown()
+{
+	// the page starts a new day header of its own
+	pagedMsgTime_ = lastMsgTime_;
+	lastMsgTime_ = QDateTime();
+}
+
+void PsiChatDlg::historyPageShown()
+{
+	lastMsgTime_ = pagedMsgTime_;
+}
+
 void PsiChatDlg::doMiniCmd()
 {
 	mCmdManager_.open(new MCmdSimpleState(MCMDCHAT, tr("Command>")), QStringList() );
@@ -61,6 +61,8 @@ private:
 	void appendNormalMessage(SpooledType spooled, const QDateTime& time, bool local, const QString& txt, const QString& subject);
 	void appendMessageFields(const Message& m);
 	void updateLastMsgTime(QDateTime t);
+	void historyPageAboutToBeShown();
+	void historyPageShown();
 	ChatView* chatView() const;
 	ChatEdit* chatEdit() const;
 
@@ -87,6 +89,7 @@ private:
 
 	bool smallChat_;
 	QDateTime lastMsgTime_;
+	QDateTime pagedMsgTime_;
 	class ChatDlgMCmdProvider;
 };
 
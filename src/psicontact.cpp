@@ -22,12 +22,10 @@
 
 #include <QFileDialog>
 #include <QTimer>
+#include <QPointer>
 
 #include "avatars.h"
 #include "common.h"
-#ifndef NEWCONTACTLIST
-# include "contactview.h"
-#endif
 #include "iconset.h"
 #include "jidutil.h"
 #include "profiles.h"
@@ -54,8 +52,47 @@
 #include "yarostertooltip.h"
 #endif
 
+static uint lastRevision = 0;
+
 static const int statusTimerInterval = 5000;
 
+/**
+ * Counts changes to the options that UserListItem::makeTip() depends on,
+ * so that cached tool tips can tell when they are out of date.
+ */
+class ToolTipOptionsWatcher : public QObject
+{
+	Q_OBJECT
+public:
+	static uint generation()
+	{
+		if (!instance_)
+			instance_ = new ToolTipOptionsWatcher();
+		return generation_;
+	}
+
+private:
+	ToolTipOptionsWatcher()
+		: QObject(PsiOptions::instance())
+	{
+		PsiOptions::instance()->subscribe("options.ui.contactlist.tooltip", this, SLOT(optionsChanged()));
+		PsiOptions::instance()->subscribe("options.ui.emoticons.use-emoticons", this, SLOT(optionsChanged()));
+		PsiOptions::instance()->subscribe("options.ui.chat.legacy-formatting", this, SLOT(optionsChanged()));
+	}
+
+	static QPointer<ToolTipOptionsWatcher> instance_;
+	static uint generation_;
+
+private slots:
+	void optionsChanged()
+	{
+		++generation_;
+	}
+};
+
+QPointer<ToolTipOptionsWatcher> ToolTipOptionsWatcher::instance_;
+uint ToolTipOptionsWatcher::generation_ = 0;
+
 class PsiContact::Private : public Alertable
 {
 	Q_OBJECT
@@ -63,6 +100,10 @@ public:
 	Private(PsiContact* contact)
 		: account_(0)
 		, statusTimer_(0)
+		, version_(1)
+		, toolTipVersion_(0)
+		, toolTipOptions_(0)
+		, statusTextVersion_(0)
 		, isValid_(true)
 		, isAnimated_(false)
 		, contact_(contact)
@@ -72,6 +113,8 @@ public:
 #endif
 	{
 		oldStatus_ = XMPP::Status(XMPP::Status::Offline);
+		revision_ = ++lastRevision;
+		connect(contact, SIGNAL(updated()), SLOT(updateRevision()));
 #ifdef YAPSI
 		showOnlineTemporarily_ = false;
 		reconnecting_ = false;
@@ -104,6 +147,15 @@ public:
 	QString name_;
 	Status status_;
 	Status oldStatus_;
+	QByteArray statusSortKey_;
+	QByteArray nameSortKey_;
+	uint revision_;
+	uint version_; //!< bumped whenever u_ or the avatar changes
+	mutable QString toolTip_;
+	mutable uint toolTipVersion_;
+	mutable uint toolTipOptions_;
+	mutable QString statusText_;
+	mutable uint statusTextVersion_;
 	bool isValid_;
 	bool isAnimated_;
 #ifdef YAPSI
@@ -136,8 +188,10 @@ public:
 #ifdef YAPSI
 		reconnecting_ = false;
 #endif
-		if (account_ && !account_->notifyOnline())
+		if (account_ && !account_->notifyOnline()) {
 			oldStatus_ = status_;
+			statusSortKey_.clear();
+		}
 		else
 			statusTimer_->start();
 	}
@@ -149,9 +203,21 @@ private slots:
 		showOnlineTemporarily_ = false;
 #endif
 		oldStatus_ = status_;
+		statusSortKey_.clear();
 		emit contact_->updated();
 	}
 
+	void updateRevision()
+	{
+		revision_ = ++lastRevision;
+	}
+
+	void invalidateSortKeys()
+	{
+		statusSortKey_.clear();
+		nameSortKey_.clear();
+	}
+
 private:
 	PsiContact* contact_;
 };
@@ -166,6 +232,7 @@ PsiContact::PsiContact(const UserListItem& u, PsiAccount* account)
 	d->account_ = account;
 	if (d->account_) {
 		connect(d->account_->avatarFactory(), SIGNAL(avatarChanged(const Jid&)), SLOT(avatarChanged(const Jid&)));
+		connect(d->account_, SIGNAL(updatedAccount()), d, SLOT(invalidateSortKeys()));
 	}
 	connect(VCardFactory::instance(), SIGNAL(vcardChanged(const Jid&)), SLOT(vcardChanged(const Jid&)));
 	update(u);
@@ -213,6 +280,8 @@ const UserListItem& PsiContact::userListItem() const
 void PsiContact::update(const UserListItem& u)
 {
 	d->u_ = u;
+	++d->version_;
+	d->invalidateSortKeys();
 	Status status = d->status(d->u_);
 
 	d->setStatus(status);
@@ -315,18 +384,29 @@ Status PsiContact::status() const
 
 QString PsiContact::statusText() const
 {
-	if (d->u_.priority() == d->u_.userResourceList().end()) {
-		return d->u_.lastUnavailableStatus().status();
+	if (d->statusTextVersion_ != d->version_) {
+		if (d->u_.priority() == d->u_.userResourceList().end())
+			d->statusText_ = d->u_.lastUnavailableStatus().status();
+		else
+			d->statusText_ = d->status_.status();
+		d->statusTextVersion_ = d->version_;
 	}
-	return d->status_.status();
+	return d->statusText_;
 }
 
 /**
- * Returns tool tip text for contact in HTML format.
+ * Returns tool tip text for contact in HTML format. It's built on first
+ * request and kept until the contact or the tool tip options change.
  */
 QString PsiContact::toolTip() const
 {
-	return d->u_.makeTip(true, false);
+	uint options = ToolTipOptionsWatcher::generation();
+	if (d->toolTipVersion_ != d->version_ || d->toolTipOptions_ != options) {
+		d->toolTip_ = d->u_.makeTip(true, false);
+		d->toolTipVersion_ = d->version_;
+		d->toolTipOptions_ = options;
+	}
+	return d->toolTip_;
 }
 
 /**
@@ -879,6 +959,7 @@ void PsiContact::avatarChanged(const Jid& j)
 {
 	if (!j.compare(jid(), false))
 		return;
+	++d->version_;
 	emit updated();
 }
 
@@ -912,15 +993,44 @@ bool PsiContact::compare(const ContactListItem* other) const
 
 	const PsiContact* contact = dynamic_cast<const PsiContact*>(other);
 	if (contact) {
-		int rank = rankStatus(d->oldStatus_.type()) - rankStatus(contact->d->oldStatus_.type());
-		if (rank == 0)
-			rank = QString::localeAwareCompare(comparisonName().toLower(), contact->comparisonName().toLower());
-		return rank < 0;
+		return compareKeys(statusSortKey(), contact->statusSortKey()) < 0;
 	}
 
 	return ContactListItem::compare(other);
 }
 
+/**
+ * Returns cached key ordering contacts by status rank, then by
+ * locale-aware comparison of comparisonName(), as compare() does.
+ */
+const QByteArray& PsiContact::statusSortKey() const
+{
+	if (d->statusSortKey_.isEmpty()) {
+		d->statusSortKey_ = collationKey(comparisonName().toLower());
+		d->statusSortKey_.prepend(char(rankStatus(d->oldStatus_.type())));
+	}
+	return d->statusSortKey_;
+}
+
+/**
+ * Returns a number that changes every time updated() is emitted. It is
+ * unique across all contacts, so views can use it as a cache key.
+ */
+uint PsiContact::revision() const
+{
+	return d->revision_;
+}
+
+/**
+ * Returns cached key ordering contacts by lower-cased name().
+ */
+const QByteArray& PsiContact::nameSortKey() const
+{
+	if (d->nameSortKey_.isEmpty())
+		d->nameSortKey_ = binaryKey(name().toLower());
+	return d->nameSortKey_;
+}
+
 // FIXME
 #ifdef YAPSI
 static YaPrivacyManager* privacyManager(PsiAccount* account)
@@ -100,6 +100,10 @@ public:
 	virtual bool compare(const ContactListItem* other) const;
 	virtual bool isRemovable() const;
 
+	const QByteArray& statusSortKey() const;
+	const QByteArray& nameSortKey() const;
+	uint revision() const;
+
 	virtual XMPP::Jid jid() const;
 	virtual XMPP::Status status() const;
 	virtual QString statusText() const;
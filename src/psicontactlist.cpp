@@ -23,6 +23,7 @@
 #include <QTimer>
 
 #include "psiaccount.h"
+#include "psicontact.h"
 #include "psievent.h"
 #include "accountadddlg.h"
 #include "serverinfomanager.h"
@@ -34,6 +35,9 @@
 PsiContactList::PsiContactList(PsiCon* psi)
 	: QObject()
 	, psi_(psi)
+	, queueCount_(0)
+	, queueLowest_(0)
+	, queueLowestValid_(false)
 	, showAgents_(false)
 	, showHidden_(false)
 	, showSelf_(false)
@@ -210,22 +214,23 @@ void PsiContactList::setAccountEnabled(PsiAccount* account, bool enabled)
 }
 
 /**
- * Counts total number of unread events for all accounts.
+ * Returns total number of unread events for all enabled accounts.
  */
 int PsiContactList::queueCount() const
 {
-	int total = 0;
-	foreach(PsiAccount* account, enabledAccounts_)
-		total += account->eventQueue()->count();
-	return total;
+	return queueCount_;
 }
 
 /**
  * Finds account with unprocessed event of highest priority, starting with
- * non-DND accounts.
+ * non-DND accounts. The result is cached until one of the queues or
+ * account statuses changes.
  */
 PsiAccount* PsiContactList::queueLowestEventId()
 {
+	if (queueLowestValid_)
+		return queueLowest_;
+
 	PsiAccount *low = 0;
 
 	// first try to get event from non-dnd account
@@ -235,9 +240,29 @@ PsiAccount* PsiContactList::queueLowestEventId()
 	if (!low)
 		low = tryQueueLowestEventId(true);
 
+	queueLowest_ = low;
+	queueLowestValid_ = true;
 	return low;
 }
 
+/**
+ * Returns number of online contacts in all enabled accounts, not counting
+ * the accounts' self contacts.
+ */
+int PsiContactList::onlineContactsCount() const
+{
+	return onlineContacts_.count();
+}
+
+/**
+ * Returns number of contacts in all enabled accounts which have an alert
+ * icon set.
+ */
+int PsiContactList::alertingContactsCount() const
+{
+	return alertingContacts_.count();
+}
+
 /**
  * Creates new PsiAccount from \param acc.
  */
@@ -287,9 +312,10 @@ void PsiContactList::link(PsiAccount* account)
 	Q_ASSERT(!accounts_.contains(account));
 	if (accounts_.contains(account))
 		return;
+	connect(account, SIGNAL(updatedActivity()), this, SLOT(accountActivityUpdated()));
 	connect(account, SIGNAL(updatedActivity()), this, SIGNAL(accountActivityChanged()));
 	connect(account->serverInfoManager(),SIGNAL(featuresChanged()), this, SIGNAL(accountFeaturesChanged()));
-	connect(account, SIGNAL(queueChanged()), this, SIGNAL(queueChanged()));
+	connect(account, SIGNAL(queueChanged()), this, SLOT(accountQueueChanged()));
 	connect(account, SIGNAL(beginBulkContactUpdate()), this, SIGNAL(beginBulkContactUpdate()));
 	connect(account, SIGNAL(endBulkContactUpdate()), this, SIGNAL(endBulkContactUpdate()));
 	connect(account, SIGNAL(rosterRequestFinished()), this, SIGNAL(rosterRequestFinished()));
@@ -308,6 +334,7 @@ void PsiContactList::unlink(PsiAccount* account)
 	Q_ASSERT(accounts_.contains(account));
 	if (!accounts_.contains(account))
 		return;
+	disconnect(account, SIGNAL(updatedActivity()), this, SLOT(accountActivityUpdated()));
 	disconnect(account, SIGNAL(updatedActivity()), this, SIGNAL(accountActivityChanged()));
 	accounts_.removeAll(account);
 	removeEnabledAccount(account);
@@ -462,6 +489,7 @@ void PsiContactList::addEnabledAccount(PsiAccount* account)
 	enabledAccounts_.append(account);
 	connect(account, SIGNAL(addedContact(PsiContact*)), SLOT(accountAddedContact(PsiContact*)));
 	connect(account, SIGNAL(removedContact(PsiContact*)), SLOT(accountRemovedContact(PsiContact*)));
+	updateQueueCount(account);
 
 	emit beginBulkContactUpdate();
 	accountAddedContact(account->selfContact());
@@ -483,22 +511,85 @@ void PsiContactList::removeEnabledAccount(PsiAccount* account)
 	disconnect(account, SIGNAL(addedContact(PsiContact*)), this, SLOT(accountAddedContact(PsiContact*)));
 	disconnect(account, SIGNAL(removedContact(PsiContact*)), this, SLOT(accountRemovedContact(PsiContact*)));
 	enabledAccounts_.removeAll(account);
+	queueCount_ -= queueCounts_.take(account);
+	queueLowestValid_ = false;
 }
 
 void PsiContactList::accountAddedContact(PsiContact* contact)
 {
-	Q_ASSERT(!contacts_.contains(contact));
+	Q_ASSERT(!contactPositions_.contains(contact));
+	contactPositions_[contact] = contacts_.count();
 	contacts_.append(contact);
+	updateContactCounters(contact);
+	connect(contact, SIGNAL(updated()), SLOT(contactUpdated()));
+	connect(contact, SIGNAL(alert()), SLOT(contactUpdated()));
 	emit addedContact(contact);
 }
 
 void PsiContactList::accountRemovedContact(PsiContact* contact)
 {
-	Q_ASSERT(contacts_.contains(contact));
-	contacts_.removeAll(contact);
+	Q_ASSERT(contactPositions_.contains(contact));
+	if (!contactPositions_.contains(contact))
+		return;
+
+	// move the last contact into the hole so that removal stays O(1)
+	int position = contactPositions_.take(contact);
+	PsiContact* last = contacts_.takeLast();
+	if (last != contact) {
+		contacts_[position] = last;
+		contactPositions_[last] = position;
+	}
+
+	onlineContacts_.remove(contact);
+	alertingContacts_.remove(contact);
+	disconnect(contact, SIGNAL(updated()), this, SLOT(contactUpdated()));
+	disconnect(contact, SIGNAL(alert()), this, SLOT(contactUpdated()));
 	emit removedContact(contact);
 }
 
+void PsiContactList::contactUpdated()
+{
+	PsiContact* contact = static_cast<PsiContact*>(sender());
+	if (contactPositions_.contains(contact))
+		updateContactCounters(contact);
+}
+
+void PsiContactList::updateContactCounters(PsiContact* contact)
+{
+	if (contact->isOnline() && !contact->isSelf())
+		onlineContacts_.insert(contact);
+	else
+		onlineContacts_.remove(contact);
+
+	if (contact->alerting())
+		alertingContacts_.insert(contact);
+	else
+		alertingContacts_.remove(contact);
+}
+
+void PsiContactList::accountQueueChanged()
+{
+	PsiAccount* account = static_cast<PsiAccount*>(sender());
+	if (enabledAccounts_.contains(account))
+		updateQueueCount(account);
+	queueLowestValid_ = false;
+	emit queueChanged();
+}
+
+void PsiContactList::accountActivityUpdated()
+{
+	// DND accounts are the last ones to be asked for events
+	queueLowestValid_ = false;
+}
+
+void PsiContactList::updateQueueCount(PsiAccount* account)
+{
+	int count = account->eventQueue()->count();
+	queueCount_ += count - queueCounts_.value(account);
+	queueCounts_[account] = count;
+	queueLowestValid_ = false;
+}
+
 bool PsiContactList::accountsLoaded() const
 {
 	return accountsLoaded_;
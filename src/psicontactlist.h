@@ -22,6 +22,8 @@
 #define PSICONTACTLIST_H
 
 #include <QList>
+#include <QHash>
+#include <QSet>
 
 #include "profiles.h"
 
@@ -71,6 +73,9 @@ public:
 	int queueCount() const;
 	PsiAccount *queueLowestEventId();
 
+	int onlineContactsCount() const;
+	int alertingContactsCount() const;
+
 	void loadAccounts(const UserAccountList &);
 	void link(PsiAccount*);
 	void unlink(PsiAccount*);
@@ -149,6 +154,9 @@ private slots:
 	void accountEnabledChanged();
 	void accountAddedContact(PsiContact*);
 	void accountRemovedContact(PsiContact*);
+	void accountQueueChanged();
+	void accountActivityUpdated();
+	void contactUpdated();
 
 private:
 	PsiAccount *loadAccount(const UserAccount &);
@@ -157,6 +165,13 @@ private:
 	PsiCon *psi_;
 	QList<PsiAccount *> accounts_, enabledAccounts_;
 	QList<PsiContact *> contacts_;
+	QHash<PsiContact*, int> contactPositions_;
+	QSet<PsiContact*> onlineContacts_;
+	QSet<PsiContact*> alertingContacts_;
+	QHash<PsiAccount*, int> queueCounts_;
+	int queueCount_;
+	PsiAccount* queueLowest_;
+	bool queueLowestValid_;
 
 	bool showAgents_;
 	bool showHidden_;
@@ -167,6 +182,8 @@ private:
 
 	void addEnabledAccount(PsiAccount* account);
 	void removeEnabledAccount(PsiAccount* account);
+	void updateQueueCount(PsiAccount* account);
+	void updateContactCounters(PsiContact* contact);
 };
 
 #endif
@@ -27,6 +27,7 @@
 #include "psioptions.h"
 #include "coloropt.h"
 #include "contactlistview.h"
+#include "contactlistrowsnapshot.h"
 #include "common.h"
 
 static const QString contactListFontOptionPath = "options.ui.look.font.contactlist";
@@ -35,11 +36,17 @@ static const QString outlinedGroupsOptionPath = "options.ui.look.contactlist.use
 static const QString contactListBackgroundOptionPath = "options.ui.look.colors.contactlist.background";
 static const QString showStatusMessagesOptionPath = "options.ui.contactlist.status-messages.show";
 static const QString statusSingleOptionPath = "options.ui.contactlist.status-messages.single-line";
+static const QString contactListColorsOptionPath = "options.ui.look.colors.contactlist.";
+static const QString iconsetsOptionPath = "options.iconsets.";
 
 PsiContactListViewDelegate::PsiContactListViewDelegate(ContactListView* parent)
 	: ContactListViewDelegate(parent)
 	, font_(0)
 	, fontMetrics_(0)
+	, statusFont_(0)
+	, statusFontMetrics_(0)
+	, layoutCache_(LayoutCacheSize)
+	, colorsDirty_(true)
 {
 	alertTimer_ = new QTimer(this);
 	alertTimer_->setInterval(100);
@@ -59,6 +66,8 @@ PsiContactListViewDelegate::~PsiContactListViewDelegate()
 {
 	delete font_;
 	delete fontMetrics_;
+	delete statusFont_;
+	delete statusFontMetrics_;
 }
 
 int PsiContactListViewDelegate::avatarSize() const
@@ -121,38 +130,105 @@ QSize PsiContactListViewDelegate::sizeHint(const QStyleOptionViewItem& /*option*
 	return QSize(0, 0);
 }
 
+/**
+ * Returns the layout of \a snapshot for a row as wide as \a option.rect,
+ * from the cache if the contact hasn't changed since it was laid out.
+ */
+const PsiContactListViewDelegate::ContactLayout* PsiContactListViewDelegate::contactLayout(const ContactListRowSnapshot& snapshot, const QStyleOptionViewItem& option) const
+{
+	quint64 key = (quint64(snapshot.revision) << 32) | quint32(option.rect.width());
+	ContactLayout* layout = layoutCache_.object(key);
+	if (!layout) {
+		layout = new ContactLayout;
+		layout->icon = PsiIconset::instance()->statusPtr(snapshot.jid, snapshot.iconStatus);
+		// see drawContact() for the icon margins
+		layoutContact(layout, snapshot, option, option.rect.width() - layout->icon->pixmap().width() - 3);
+		layoutCache_.insert(key, layout);
+	}
+	return layout;
+}
+
+void PsiContactListViewDelegate::layoutContact(ContactLayout* layout, const ContactListRowSnapshot& snapshot, const QStyleOptionViewItem& option, int textWidth) const
+{
+	layout->textWidth = textWidth;
+	layout->twoLines = false;
+	layout->status = QString();
+	layout->statusClipped = false;
+
+	QString name = snapshot.name;
+	if (showStatusMessages_ && !snapshot.statusText.isEmpty()) {
+		if (!statusSingle_) {
+			name = tr("%1 (%2)").arg(name).arg(snapshot.statusText);
+		}
+		else {
+			layout->twoLines = true;
+			layout->statusClipped = statusFontMetrics_->width(snapshot.statusText) > textWidth;
+			layout->status = layout->statusClipped ?
+			                 statusFontMetrics_->elidedText(snapshot.statusText, option.textElideMode, textWidth) :
+			                 snapshot.statusText;
+		}
+	}
+
+	layout->nameClipped = fontMetrics_->width(name) > textWidth;
+	layout->name = layout->nameClipped ?
+	               fontMetrics_->elidedText(name, option.textElideMode, textWidth) :
+	               name;
+}
+
+void PsiContactListViewDelegate::updateColors() const
+{
+	ColorOpt* colors = ColorOpt::instance();
+	awayColor_ = colors->color("options.ui.look.colors.contactlist.status.away");
+	dndColor_ = colors->color("options.ui.look.colors.contactlist.status.do-not-disturb");
+	offlineColor_ = colors->color("options.ui.look.colors.contactlist.status.offline");
+	onlineColor_ = colors->color("options.ui.look.colors.contactlist.status.online");
+	animation1Color_ = colors->color("options.ui.look.colors.contactlist.status-change-animation1");
+	animation2Color_ = colors->color("options.ui.look.colors.contactlist.status-change-animation2");
+	statusMessagesColor_ = colors->color("options.ui.look.colors.contactlist.status-messages");
+	colorsDirty_ = false;
+}
+
 void PsiContactListViewDelegate::drawContact(QPainter* painter, const QStyleOptionViewItem& option, const QModelIndex& index) const
 {
 	drawBackground(painter, option, index);
 
+	const ContactListRowSnapshot snapshot = qvariant_cast<ContactListRowSnapshot>(index.data(ContactListModel::RowSnapshotRole));
+	const ContactLayout* layout = contactLayout(snapshot, option);
+
 	QRect r = option.rect;
 
 	QRect avatarRect(r);
-	const QPixmap statusPixmap = this->statusPixmap(index);
+	const QPixmap statusPixmap = snapshot.isAlerting ? this->statusPixmap(index) : layout->icon->pixmap();
 	avatarRect.translate(1, 1);
 	avatarRect.setSize(statusPixmap.size());
 	painter->drawPixmap(avatarRect.topLeft(), statusPixmap);
 
 	r.setLeft(avatarRect.right() + 3);
 
+	// alert and animated icons may differ in size from the one the text was laid out for
+	ContactLayout adjusted;
+	if (r.width() != layout->textWidth) {
+		adjusted.icon = layout->icon;
+		layoutContact(&adjusted, snapshot, option, r.width());
+		layout = &adjusted;
+	}
+
+	if (colorsDirty_)
+		updateColors();
+
 	QColor textColor;
-	if(index.data(ContactListModel::IsAnimRole).toBool()) {
-		if(index.data(ContactListModel::PhaseRole).toBool()) {
-			textColor = ColorOpt::instance()->color("options.ui.look.colors.contactlist.status-change-animation2");
-		}
-		else {
-			textColor = ColorOpt::instance()->color("options.ui.look.colors.contactlist.status-change-animation1");
-		}
+	if (snapshot.isAnimated) {
+		textColor = snapshot.phase ? animation2Color_ : animation1Color_;
 	}
 	else {
-		if (statusType(index) == XMPP::Status::Away || statusType(index) == XMPP::Status::XA)
-			textColor = ColorOpt::instance()->color("options.ui.look.colors.contactlist.status.away");
-		else if (statusType(index) == XMPP::Status::DND)
-			textColor = ColorOpt::instance()->color("options.ui.look.colors.contactlist.status.do-not-disturb");
-		else if (statusType(index) == XMPP::Status::Offline)
-			textColor = ColorOpt::instance()->color("options.ui.look.colors.contactlist.status.offline");
+		if (snapshot.statusType == XMPP::Status::Away || snapshot.statusType == XMPP::Status::XA)
+			textColor = awayColor_;
+		else if (snapshot.statusType == XMPP::Status::DND)
+			textColor = dndColor_;
+		else if (snapshot.statusType == XMPP::Status::Offline)
+			textColor = offlineColor_;
 		else
-			textColor = ColorOpt::instance()->color("options.ui.look.colors.contactlist.status.online");
+			textColor = onlineColor_;
 	}
 
 	QStyleOptionViewItemV2 o = option;
@@ -162,31 +238,23 @@ void PsiContactListViewDelegate::drawContact(QPainter* painter, const QStyleOpti
 	palette.setColor(QPalette::Text, textColor);
 	o.palette = palette;
 
-	QString text = nameText(o, index);
-	if (showStatusMessages_ && !statusText(index).isEmpty()) {
-		if(!statusSingle_) {
-			text = tr("%1 (%2)").arg(text).arg(statusText(index));
-			drawText(painter, o, r, text, index);
-		}
-		else {
-			QRect txtRect(r);
-			txtRect.setHeight(r.height()*2/3);
-			drawText(painter, o, txtRect, text, index);
-			QString statusMsg = statusText(index);
-			palette.setColor(QPalette::Text, ColorOpt::instance()->color("options.ui.look.colors.contactlist.status-messages"));
-			o.palette = palette;
-			txtRect.moveTopRight(txtRect.bottomRight());
-			txtRect.setHeight(r.height() - txtRect.height());
-			o.font.setPointSize(qMax(o.font.pointSize()-2, 7));
-			o.fontMetrics = QFontMetrics(o.font);
-			drawText(painter, o, txtRect, statusMsg, index);
-		}
+	if (layout->twoLines) {
+		QRect txtRect(r);
+		txtRect.setHeight(r.height()*2/3);
+		drawLaidOutText(painter, o, txtRect, layout->name, layout->nameClipped);
+		palette.setColor(QPalette::Text, statusMessagesColor_);
+		o.palette = palette;
+		txtRect.moveTopRight(txtRect.bottomRight());
+		txtRect.setHeight(r.height() - txtRect.height());
+		o.font = *statusFont_;
+		o.fontMetrics = *statusFontMetrics_;
+		drawLaidOutText(painter, o, txtRect, layout->status, layout->statusClipped);
 	}
 	else {
-		if(showStatusMessages_ && statusSingle_)
+		if (showStatusMessages_ && statusSingle_)
 			r.setHeight(r.height()*2/3);
 
-		drawText(painter, o, r, text, index);
+		drawLaidOutText(painter, o, r, layout->name, layout->nameClipped);
 	}
 
 #if 0
@@ -334,6 +402,14 @@ void PsiContactListViewDelegate::optionChanged(const QString& option)
 		font_->fromString(PsiOptions::instance()->getOption(contactListFontOptionPath).toString());
 		fontMetrics_ = new QFontMetrics(*font_);
 		rowHeight_ = qMax(fontMetrics_->height()+2, 18); // 18 - default row height
+
+		delete statusFont_;
+		delete statusFontMetrics_;
+		statusFont_ = new QFont(*font_);
+		statusFont_->setPointSize(qMax(font_->pointSize()-2, 7));
+		statusFontMetrics_ = new QFontMetrics(*statusFont_);
+
+		layoutCache_.clear();
 		contactList()->viewport()->update();
 	}
 	else if (option == contactListBackgroundOptionPath) {
@@ -344,6 +420,7 @@ void PsiContactListViewDelegate::optionChanged(const QString& option)
 	}
 	else if (option == showStatusMessagesOptionPath) {
 		showStatusMessages_ = PsiOptions::instance()->getOption(showStatusMessagesOptionPath).toBool();
+		layoutCache_.clear();
 		contactList()->viewport()->update();
 	}
 	else if(option == slimGroupsOptionPath) {
@@ -356,6 +433,17 @@ void PsiContactListViewDelegate::optionChanged(const QString& option)
 	}
 	else if(option == statusSingleOptionPath) {
 		statusSingle_ = !PsiOptions::instance()->getOption(statusSingleOptionPath).toBool();
+		layoutCache_.clear();
+		contactList()->viewport()->update();
+	}
+	else if (option.startsWith(contactListColorsOptionPath)) {
+		// ColorOpt may not have seen the change yet
+		colorsDirty_ = true;
+		contactList()->viewport()->update();
+	}
+	else if (option.startsWith(iconsetsOptionPath)) {
+		// cached PsiIcon pointers belong to the old iconsets
+		layoutCache_.clear();
 		contactList()->viewport()->update();
 	}
 }
@@ -368,6 +456,30 @@ void PsiContactListViewDelegate::drawText(QPainter* painter, const QStyleOptionV
 	ContactListViewDelegate::drawText(painter, o, r, text, index);
 }
 
+/**
+ * Like drawText(), but for text that was already elided by layoutContact().
+ */
+void PsiContactListViewDelegate::drawLaidOutText(QPainter* painter, const QStyleOptionViewItem& o, const QRect& rect, const QString& text, bool clipped) const
+{
+	if (text.isEmpty())
+		return;
+
+	QRect r(rect);
+	r.moveTop(r.top() + (r.height() - o.fontMetrics.height()) / 2);
+	setTextPen(painter, o);
+
+	if (clipped) {
+		painter->save();
+		painter->setClipRect(r);
+	}
+
+	painter->setFont(o.font);
+	painter->drawText(r.x(), r.y() + o.fontMetrics.ascent(), text);
+
+	if (clipped)
+		painter->restore();
+}
+
 void PsiContactListViewDelegate::contactAlert(const QModelIndex& index)
 {
 	bool alerting = index.data(ContactListModel::IsAlertingRole).toBool();
@@ -21,8 +21,13 @@
 #ifndef PSICONTACTLISTVIEWDELEGATE_H
 #define PSICONTACTLISTVIEWDELEGATE_H
 
+#include <QCache>
+
 #include "contactlistviewdelegate.h"
 
+class PsiIcon;
+class ContactListRowSnapshot;
+
 class PsiContactListViewDelegate : public ContactListViewDelegate
 {
 	Q_OBJECT
@@ -58,13 +63,41 @@ private slots:
 	void updateAlerts();
 
 private:
+	/**
+	 * \brief Laid-out text and status icon of a contact row
+	 */
+	class ContactLayout
+	{
+	public:
+		int textWidth;
+		PsiIcon* icon;
+		bool twoLines;
+		QString name;
+		bool nameClipped;
+		QString status;
+		bool statusClipped;
+	};
+
+	enum { LayoutCacheSize = 2048 };
+
 	QTimer* alertTimer_;
 	QFont* font_;
 	QFontMetrics* fontMetrics_;
+	QFont* statusFont_;
+	QFontMetrics* statusFontMetrics_;
 	bool statusSingle_;
 	int rowHeight_;
 	bool showStatusMessages_, slimGroup_, outlinedGroup_;
 	mutable QHash<QModelIndex, bool> alertingIndexes_;
+	mutable QCache<quint64, ContactLayout> layoutCache_;
+	mutable bool colorsDirty_;
+	mutable QColor awayColor_, dndColor_, offlineColor_, onlineColor_;
+	mutable QColor animation1Color_, animation2Color_, statusMessagesColor_;
+
+	const ContactLayout* contactLayout(const ContactListRowSnapshot& snapshot, const QStyleOptionViewItem& option) const;
+	void layoutContact(ContactLayout* layout, const ContactListRowSnapshot& snapshot, const QStyleOptionViewItem& option, int textWidth) const;
+	void updateColors() const;
+	void drawLaidOutText(QPainter* painter, const QStyleOptionViewItem& o, const QRect& rect, const QString& text, bool clipped) const;
 };
 
 #endif
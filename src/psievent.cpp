@@ -24,6 +24,7 @@
 #include <QTextStream>
 #include <QList>
 #include <QCoreApplication>
+#include <QFile>
 
 #include "psicon.h"
 #include "psiaccount.h"
@@ -777,10 +778,21 @@ PsiEvent* EventItem::event() const
 // EventQueue
 //----------------------------------------------------------------------------
 
+// The journal is a header line followed by records:
+//   +<item id> <length>\n<length bytes of event xml>\n
+//   -<item id>\n
+// It is rewritten from scratch once it holds JOURNALCOMPACTFACTOR times
+// more records than there are queued events.
+static const char *journalHeader = "psi-event-journal 1\n";
+enum {JOURNALCOMPACTMIN = 256, JOURNALCOMPACTFACTOR = 4};
+
 EventQueue::EventQueue(PsiAccount *account)
-	: psi_(0)
+	: nextOrder_(0)
+	, psi_(0)
 	, account_(0)
 	, enabled_(false)
+	, journal_(0)
+	, journalRecords_(0)
 {
 	account_ = account;
 	psi_ = account_->psi();
@@ -788,9 +800,12 @@ EventQueue::EventQueue(PsiAccount *account)
 
 EventQueue::EventQueue(const EventQueue &from)
 	: QObject()
+	, nextOrder_(0)
 	, psi_(0)
 	, account_(0)
 	, enabled_(false)
+	, journal_(0)
+	, journalRecords_(0)
 {
 	Q_ASSERT(false);
 	Q_UNUSED(from);
@@ -799,6 +814,7 @@ EventQueue::EventQueue(const EventQueue &from)
 EventQueue::~EventQueue()
 {
 	setEnabled(false);
+	delete journal_;
 }
 
 bool EventQueue::enabled() const
@@ -821,8 +837,13 @@ void EventQueue::setEnabled(bool enabled)
 
 EventQueue &EventQueue::operator= (const EventQueue &from)
 {
-	while(!list_.isEmpty())
-		delete list_.takeFirst();
+	qDeleteAll(list_);
+	list_.clear();
+	jidIndex_.clear();
+	fromIndex_.clear();
+	chatCount_.clear();
+	typeCount_.clear();
+	keys_.clear();
 
 	psi_ = from.psi_;
 	account_ = from.account_;
@@ -835,12 +856,100 @@ EventQueue &EventQueue::operator= (const EventQueue &from)
 	return *this;
 }
 
+bool EventQueue::isChat(const PsiEvent *e)
+{
+	if(e->type() != PsiEvent::Message)
+		return false;
+	const MessageEvent *me = static_cast<const MessageEvent *>(e);
+	return me->message().type() == "chat"; // FIXME: refactor-refactor-refactor
+}
+
+/**
+ * Returns events whose jid() matches \a j, in queue order. Only the bucket
+ * of the bare jid is looked at, so this doesn't depend on the queue size.
+ */
+QList<EventItem*> EventQueue::jidBucket(const Jid &j, bool compareRes) const
+{
+	OrderMap bucket = jidIndex_.value(j.bare());
+	if (!compareRes)
+		return bucket.values();
+
+	QList<EventItem*> result;
+	foreach(EventItem *i, bucket) {
+		if(j.compare(i->event()->jid(), true))
+			result.append(i);
+	}
+	return result;
+}
+
+/**
+ * Adds \a i to list_ and to the per-jid indexes. All of them are maps
+ * sorted by the same key, priority first, then arrival, so inserting and
+ * removing an item doesn't depend on the queue length.
+ */
+void EventQueue::indexItem(EventItem *i)
+{
+	PsiEvent *e = i->event();
+
+	IndexKey key;
+	key.jid = e->jid().bare();
+	key.from = e->from().bare();
+	key.chat = isChat(e);
+	key.order = OrderKey(-e->priority(), nextOrder_++);
+	keys_.insert(i, key);
+
+	list_.insert(key.order, i);
+	jidIndex_[key.jid].insert(key.order, i);
+	fromIndex_[key.from].insert(key.order, i);
+
+	if (key.chat)
+		++chatCount_[key.from];
+	++typeCount_[e->type()];
+}
+
+void EventQueue::unindexItem(EventItem *i)
+{
+	IndexKey key = keys_.take(i);
+	PsiEvent *e = i->event();
+
+	list_.remove(key.order);
+
+	OrderMap &byJid = jidIndex_[key.jid];
+	byJid.remove(key.order);
+	if (byJid.isEmpty())
+		jidIndex_.remove(key.jid);
+
+	OrderMap &byFrom = fromIndex_[key.from];
+	byFrom.remove(key.order);
+	if (byFrom.isEmpty())
+		fromIndex_.remove(key.from);
+
+	if (key.chat && --chatCount_[key.from] <= 0)
+		chatCount_.remove(key.from);
+	if (--typeCount_[e->type()] <= 0)
+		typeCount_.remove(e->type());
+}
+
+/**
+ * Removes \a i from the queue and deletes it. The event itself is kept.
+ */
+void EventQueue::takeItem(EventItem *i)
+{
+	if (enabled_) {
+		GlobalEventQueue::instance()->dequeue(i);
+	}
+	unindexItem(i);
+	if (journal_)
+		journalAppend("-" + QByteArray::number(i->id()) + "\n");
+	delete i;
+}
+
 int EventQueue::nextId() const
 {
 	if (list_.isEmpty())
 		return -1;
 
-	EventItem *i = list_.first();
+	EventItem *i = list_.constBegin().value();
 	if(!i)
 		return -1;
 	return i->id();
@@ -853,13 +962,17 @@ int EventQueue::count() const
 
 int EventQueue::count(const Jid &j, bool compareRes) const
 {
-	int total = 0;
-	foreach(EventItem *i, list_) {
-		Jid j2(i->event()->jid());
-		if(j.compare(j2, compareRes))
-			++total;
-	}
-	return total;
+	if (!compareRes)
+		return jidIndex_.value(j.bare()).count();
+	return jidBucket(j, compareRes).count();
+}
+
+/**
+ * Returns number of queued events of the given PsiEvent type.
+ */
+int EventQueue::countType(int type) const
+{
+	return typeCount_.value(type);
 }
 
 void EventQueue::enqueue(PsiEvent *e)
@@ -870,21 +983,9 @@ void EventQueue::enqueue(PsiEvent *e)
 		GlobalEventQueue::instance()->enqueue(i);
 	}
 
-	int prior  = e->priority();
-	bool found = false;
-
-	// skip all with higher or equal priority
-	foreach(EventItem *ei, list_) {
-		if (ei && ei->event()->priority() < prior ) {
-			list_.insert(list_.indexOf(ei), i);
-			found = true;
-			break;
-		}
-	}
-
-	// everything else
-	if ( !found )
-		list_.append(i);
+	indexItem(i);
+	if (journal_)
+		journalAppend(journalEnqueueRecord(i));
 
 	emit queueChanged();
 }
@@ -894,49 +995,43 @@ void EventQueue::dequeue(PsiEvent *e)
 	if ( !e )
 		return;
 
-	foreach(EventItem *i, list_) {
+	foreach(EventItem *i, jidIndex_.value(e->jid().bare())) {
 		if ( e == i->event() ) {
-			if (enabled_) {
-				GlobalEventQueue::instance()->dequeue(i);
-			}
-			list_.removeAll(i);
+			takeItem(i);
 			emit queueChanged();
-			delete i;
 			return;
 		}
 	}
-}
 
-PsiEvent *EventQueue::dequeue(const Jid &j, bool compareRes)
-{
+	// jid was changed after the event got queued
 	foreach(EventItem *i, list_) {
-		PsiEvent *e = i->event();
-		Jid j2(e->jid());
-		if(j.compare(j2, compareRes)) {
-			if (enabled_) {
-				GlobalEventQueue::instance()->dequeue(i);
-			}
-			list_.removeAll(i);
+		if ( e == i->event() ) {
+			takeItem(i);
 			emit queueChanged();
-			delete i;
-			return e;
+			return;
 		}
 	}
+}
 
-	return 0;
+PsiEvent *EventQueue::dequeue(const Jid &j, bool compareRes)
+{
+	QList<EventItem*> bucket = jidBucket(j, compareRes);
+	if (bucket.isEmpty())
+		return 0;
+
+	EventItem *i = bucket.first();
+	PsiEvent *e = i->event();
+	takeItem(i);
+	emit queueChanged();
+	return e;
 }
 
 PsiEvent *EventQueue::peek(const Jid &j, bool compareRes) const
 {
-	foreach(EventItem *i, list_) {
-		PsiEvent *e = i->event();
-		Jid j2(e->jid());
-		if(j.compare(j2, compareRes)) {
-			return e;
-		}
-	}
-
-	return 0;
+	QList<EventItem*> bucket = jidBucket(j, compareRes);
+	if (bucket.isEmpty())
+		return 0;
+	return bucket.first()->event();
 }
 
 PsiEvent *EventQueue::dequeueNext()
@@ -944,16 +1039,12 @@ PsiEvent *EventQueue::dequeueNext()
 	if (list_.isEmpty())
 		return 0;
 
-	EventItem *i = list_.first();
+	EventItem *i = list_.constBegin().value();
 	if(!i)
 		return 0;
 	PsiEvent *e = i->event();
-	if (enabled_) {
-		GlobalEventQueue::instance()->dequeue(i);
-	}
-	list_.removeAll(i);
+	takeItem(i);
 	emit queueChanged();
-	delete i;
 	return e;
 }
 
@@ -962,7 +1053,7 @@ PsiEvent *EventQueue::peekNext() const
 	if (list_.isEmpty())
 		return 0;
 
-	EventItem *i = list_.first();
+	EventItem *i = list_.constBegin().value();
 	if(!i)
 		return 0;
 	return i->event();
@@ -970,13 +1061,12 @@ PsiEvent *EventQueue::peekNext() const
 
 PsiEvent *EventQueue::peekFirstChat(const Jid &j, bool compareRes) const
 {
-	foreach(EventItem *i, list_) {
-		PsiEvent *e = i->event();
-		if(e->type() == PsiEvent::Message) {
-			MessageEvent *me = (MessageEvent *)e;
-			if(j.compare(me->from(), compareRes) && me->message().type() == "chat")
-				return e;
-		}
+	if (!chatCount_.contains(j.bare()))
+		return 0;
+
+	foreach(EventItem *i, fromIndex_.value(j.bare())) {
+		if(keys_.value(i).chat && j.compare(i->event()->from(), compareRes))
+			return i->event();
 	}
 
 	return 0;
@@ -984,40 +1074,30 @@ PsiEvent *EventQueue::peekFirstChat(const Jid &j, bool compareRes) const
 
 bool EventQueue::hasChats(const Jid &j, bool compareRes) const
 {
+	if (!compareRes)
+		return chatCount_.contains(j.bare());
 	return (peekFirstChat(j, compareRes) ? true: false);
 }
 
 // this function extracts all chats from the queue, and returns a list of queue positions
 void EventQueue::extractChats(QList<PsiEvent*> *el, const Jid &j, bool compareRes, bool removeEvents)
 {
+	if (!chatCount_.contains(j.bare()))
+		return;
+
 	bool changed = false;
 
-	for(QList<EventItem*>::Iterator it = list_.begin(); it != list_.end();) {
-		PsiEvent *e = (*it)->event();
-		bool extract = false;
-		if(e->type() == PsiEvent::Message) {
-			MessageEvent *me = (MessageEvent *)e;
-			if(j.compare(me->from(), compareRes) && me->message().type() == "chat") { // FIXME: refactor-refactor-refactor
-				extract = true;
-			}
-		}
+	foreach(EventItem *i, fromIndex_.value(j.bare())) {
+		PsiEvent *e = i->event();
+		if(!keys_.value(i).chat || !j.compare(e->from(), compareRes))
+			continue;
 
-		if (extract) {
-			el->append(e);
-		}
+		el->append(e);
 
-		if (extract && removeEvents) {
-			EventItem* ei = *it;
-			if (enabled_) {
-				GlobalEventQueue::instance()->dequeue(ei);
-			}
-			it = list_.erase(it);
-			delete ei;
+		if (removeEvents) {
+			takeItem(i);
 			changed = true;
-			continue;
 		}
-
-		++it;
 	}
 
 	if ( changed )
@@ -1027,22 +1107,18 @@ void EventQueue::extractChats(QList<PsiEvent*> *el, const Jid &j, bool compareRe
 // this function extracts all messages from the queue, and returns a list of them
 void EventQueue::extractMessages(QList<PsiEvent*> *el)
 {
+	if (!typeCount_.contains(PsiEvent::Message))
+		return;
+
 	bool changed = false;
 
-	for(QList<EventItem*>::Iterator it = list_.begin(); it != list_.end();) {
-		PsiEvent *e = (*it)->event();
+	foreach(EventItem *i, list_) {
+		PsiEvent *e = i->event();
 		if(e->type() == PsiEvent::Message) {
 			el->append(e);
-			EventItem* ei = *it;
-			if (enabled_) {
-				GlobalEventQueue::instance()->dequeue(ei);
-			}
-			it = list_.erase(it);
-			delete ei;
+			takeItem(i);
 			changed = true;
-			continue;
 		}
-		++it;
 	}
 
 	if ( changed )
@@ -1059,8 +1135,15 @@ void EventQueue::printContent() const
 
 void EventQueue::clear()
 {
-	while(!list_.isEmpty())
-		delete list_.takeFirst();
+	qDeleteAll(list_);
+	list_.clear();
+	jidIndex_.clear();
+	fromIndex_.clear();
+	chatCount_.clear();
+	typeCount_.clear();
+	keys_.clear();
+	if (journal_)
+		compactJournal();
 
 	emit queueChanged();
 }
@@ -1070,20 +1153,9 @@ void EventQueue::clear(const Jid &j, bool compareRes)
 {
 	bool changed = false;
 
-	for(QList<EventItem*>::Iterator it = list_.begin(); it != list_.end();) {
-		PsiEvent *e = (*it)->event();
-		Jid j2(e->jid());
-		if(j.compare(j2, compareRes)) {
-			EventItem* ei = *it;
-			if (enabled_) {
-				GlobalEventQueue::instance()->dequeue(ei);
-			}
-			it = list_.erase(it);
-			delete ei;
-			changed = true;
-		}
-		else
-			++it;
+	foreach(EventItem *i, jidBucket(j, compareRes)) {
+		takeItem(i);
+		changed = true;
 	}
 
 	if ( changed )
@@ -1125,23 +1197,7 @@ bool EventQueue::fromXml(const QDomElement *q)
 		if ( e.tagName() != "event" )
 			continue;
 
-		PsiEvent *event = 0;
-		QString eventType = e.attribute("type");
-		if ( eventType == "MessageEvent" ) {
-			event = new MessageEvent(0);
-			if ( !event->fromXml(psi_, account_, &e) ) {
-				delete event;
-				event = 0;
-			}
-		}
-		else if ( eventType == "AuthEvent" ) {
-			event = new AuthEvent("", "", 0);
-			if ( !event->fromXml(psi_, account_, &e) ) {
-				delete event;
-				event = 0;
-			}
-		}
-
+		PsiEvent *event = eventFromElement(e);
 		if ( event )
 			emit eventFromXml( event );
 	}
@@ -1149,11 +1205,30 @@ bool EventQueue::fromXml(const QDomElement *q)
 	return true;
 }
 
+PsiEvent *EventQueue::eventFromElement(const QDomElement &e)
+{
+	PsiEvent *event = 0;
+	QString eventType = e.attribute("type");
+	if ( eventType == "MessageEvent" ) {
+		event = new MessageEvent(0);
+	}
+	else if ( eventType == "AuthEvent" ) {
+		event = new AuthEvent("", "", 0);
+	}
+
+	if ( event && !event->fromXml(psi_, account_, &e) ) {
+		delete event;
+		event = 0;
+	}
+
+	return event;
+}
+
 QList<EventQueue::PsiEventId> EventQueue::eventsFor(const XMPP::Jid& jid, bool compareRes)
 {
 	QList<PsiEventId> result;
 
-	foreach(EventItem* i, list_) {
+	foreach(EventItem* i, fromIndex_.value(jid.bare())) {
 		if (i->event()->from().compare(jid, compareRes))
 			result << QPair<int, PsiEvent*>(i->id(), i->event());
 	}
@@ -1182,4 +1257,172 @@ bool EventQueue::fromFile(const QString &fname)
 	return fromXml(&base);
 }
 
+QString EventQueue::journalFile() const
+{
+	return journalName_;
+}
+
+/**
+ * Starts recording every enqueue and dequeue into the journal \a fname.
+ * The journal is rewritten with the current queue contents first, so
+ * anything loaded with fromJournal() or fromFile() before this call is
+ * kept. Pass an empty string to stop journaling.
+ */
+bool EventQueue::setJournalFile(const QString &fname)
+{
+	delete journal_;
+	journal_ = 0;
+	journalRecords_ = 0;
+	journalName_ = fname;
+
+	if (journalName_.isEmpty())
+		return true;
+
+	return compactJournal();
+}
+
+/**
+ * Replays the journal \a fname and emits eventFromXml() for every event
+ * that was still queued. A record cut short by a crash ends the replay.
+ */
+bool EventQueue::fromJournal(const QString &fname)
+{
+	// compactJournal() died between removing the old journal and renaming
+	// the new one into place
+	QString name = fname;
+	if (!QFile::exists(name) && QFile::exists(name + ".new"))
+		name += ".new";
+
+	QFile f(name);
+	if (!f.open(QIODevice::ReadOnly))
+		return false;
+
+	if (f.readLine() != journalHeader)
+		return false;
+
+	QList<QByteArray> records;
+	QHash<int, int> recordIndex;
+	while (!f.atEnd()) {
+		QByteArray line = f.readLine();
+		if (!line.endsWith('\n'))
+			break;
+		line.chop(1);
+
+		if (line.startsWith('+')) {
+			int sp = line.indexOf(' ');
+			bool idOk = false, lenOk = false;
+			int id = line.mid(1, sp - 1).toInt(&idOk);
+			int len = line.mid(sp + 1).toInt(&lenOk);
+			if (sp < 0 || !idOk || !lenOk || len < 0)
+				break;
+
+			QByteArray xml = f.read(len);
+			if (xml.size() != len || f.read(1) != "\n")
+				break;
+
+			recordIndex[id] = records.count();
+			records += xml;
+		}
+		else if (line.startsWith('-')) {
+			bool idOk = false;
+			int id = line.mid(1).toInt(&idOk);
+			if (!idOk)
+				break;
+			if (recordIndex.contains(id))
+				records[recordIndex.take(id)] = QByteArray();
+		}
+		else {
+			break;
+		}
+	}
+	f.close();
+
+	foreach(const QByteArray &xml, records) {
+		if (xml.isEmpty())
+			continue;
+
+		QDomDocument doc;
+		if (!doc.setContent(xml))
+			continue;
+
+		PsiEvent *event = eventFromElement(doc.documentElement());
+		if ( event )
+			emit eventFromXml( event );
+	}
+
+	return true;
+}
+
+/**
+ * Replaces the journal with one holding only the currently queued events.
+ * The new journal is written next to the old one and renamed into place,
+ * so a crash at any point leaves a complete journal behind.
+ */
+bool EventQueue::compactJournal()
+{
+	if (journalName_.isEmpty())
+		return false;
+
+	delete journal_;
+	journal_ = 0;
+
+	QString tmpName = journalName_ + ".new";
+	QFile tmp(tmpName);
+	bool ok = tmp.open(QIODevice::WriteOnly | QIODevice::Truncate);
+	if (ok)
+		ok = tmp.write(journalHeader) != -1;
+	foreach(EventItem *i, list_) {
+		if (!ok)
+			break;
+		ok = tmp.write(journalEnqueueRecord(i)) != -1;
+	}
+	if (ok)
+		ok = tmp.flush();
+	tmp.close();
+
+	if (ok) {
+		QFile::remove(journalName_);
+		ok = QFile::rename(tmpName, journalName_);
+	}
+	else {
+		tmp.remove();
+	}
+
+	if (ok)
+		journalRecords_ = list_.count();
+	else
+		qWarning("EventQueue: unable to compact %s", qPrintable(journalName_));
+
+	journal_ = new QFile(journalName_);
+	if (!journal_->open(QIODevice::WriteOnly | QIODevice::Append)) {
+		qWarning("EventQueue: unable to open %s", qPrintable(journalName_));
+		delete journal_;
+		journal_ = 0;
+		return false;
+	}
+
+	return ok;
+}
+
+QByteArray EventQueue::journalEnqueueRecord(const EventItem *i)
+{
+	QDomDocument doc;
+	doc.appendChild(i->event()->toXml(&doc));
+	QByteArray xml = doc.toByteArray(-1);
+
+	return "+" + QByteArray::number(i->id()) + " " + QByteArray::number(xml.size()) + "\n" + xml + "\n";
+}
+
+void EventQueue::journalAppend(const QByteArray &record)
+{
+	if (journal_->write(record) != record.size() || !journal_->flush()) {
+		qWarning("EventQueue: unable to write %s", qPrintable(journalName_));
+		return;
+	}
+
+	++journalRecords_;
+	if (journalRecords_ > JOURNALCOMPACTMIN && journalRecords_ > JOURNALCOMPACTFACTOR * list_.count())
+		compactJournal();
+}
+
 #include "psievent.moc"
@@ -22,6 +22,9 @@
 #define PSIEVENT_H
 
 #include <QList>
+#include <QHash>
+#include <QMap>
+#include <QPair>
 #include <QDateTime>
 #include <QObject>
 #include <QDomDocument>
@@ -33,6 +36,8 @@
 #include "xmpp_message.h"
 #include "psihttpauthrequest.h"
 
+class QFile;
+
 namespace XMPP {
 	class FileTransfer;
 };
@@ -332,6 +337,7 @@ public:
 	int nextId() const;
 	int count() const;
 	int count(const XMPP::Jid &, bool compareRes=true) const;
+	int countType(int type) const;
 	void enqueue(PsiEvent *);
 	void dequeue(PsiEvent *);
 	PsiEvent *dequeue(const XMPP::Jid &, bool compareRes=true);
@@ -354,15 +360,50 @@ public:
 	bool toFile(const QString &fname);
 	bool fromFile(const QString &fname);
 
+	QString journalFile() const;
+	bool setJournalFile(const QString &fname);
+	bool fromJournal(const QString &fname);
+	bool compactJournal();
+
 signals:
 	void eventFromXml(PsiEvent *);
 	void queueChanged();
 
 private:
-	QList<EventItem*> list_;
+	// queue order: higher priority first, then arrival
+	typedef QPair<int, qint64> OrderKey;
+	typedef QMap<OrderKey, EventItem*> OrderMap;
+
+	struct IndexKey {
+		QString jid;
+		QString from;
+		bool chat;
+		OrderKey order;
+	};
+
+	static bool isChat(const PsiEvent *e);
+	QList<EventItem*> jidBucket(const XMPP::Jid &, bool compareRes) const;
+	void indexItem(EventItem *i);
+	void unindexItem(EventItem *i);
+	void takeItem(EventItem *i);
+	PsiEvent *eventFromElement(const QDomElement &e);
+	void journalAppend(const QByteArray &record);
+	static QByteArray journalEnqueueRecord(const EventItem *i);
+
+	OrderMap list_;
+	// per-bare-jid views of list_ (keyed by jid() and from() respectively)
+	QHash<QString, OrderMap> jidIndex_;
+	QHash<QString, OrderMap> fromIndex_;
+	QHash<QString, int> chatCount_;
+	QHash<int, int> typeCount_;
+	QHash<EventItem*, IndexKey> keys_;
+	qint64 nextOrder_;
 	PsiCon* psi_;
 	PsiAccount* account_;
 	bool enabled_;
+	QString journalName_;
+	QFile *journal_;
+	int journalRecords_;
 };
 
 
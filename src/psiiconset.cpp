@@ -48,8 +48,24 @@ public:
 	QMap<QString, QString> cur_service_status;
 	QMap<QString, QString> cur_custom_status;
 
+	struct IconRule {
+		QRegExp rx;
+		const Iconset *iconset;
+	};
+	enum {MAXCACHEDICONS = 16384};
+
+	bool rulesValid;
+	bool useTransportIcons;
+	QList<IconRule> serviceRules;
+	const Iconset *transportIconset;
+	QList<IconRule> customRules;
+	QHash<QPair<QString, QString>, PsiIcon*> iconCache; // (bare jid, icon name)
+
 	Private(PsiIconset *_psi) {
 		psi = _psi;
+		rulesValid = false;
+		useTransportIcons = false;
+		transportIconset = 0;
 	}
 
 	QString iconsetPath(QString name) {
@@ -124,76 +140,119 @@ public:
 	}
 
 	PsiIcon *jid2icon(const Jid &jid, const QString &iconName)
+	{
+		if ( !rulesValid )
+			compileRules();
+
+		QPair<QString, QString> key(jid.bare(), iconName);
+		QHash<QPair<QString, QString>, PsiIcon*>::ConstIterator it = iconCache.constFind(key);
+		if ( it != iconCache.constEnd() )
+			return it.value();
+
+		if ( iconCache.count() >= MAXCACHEDICONS )
+			iconCache.clear();
+
+		PsiIcon *icon = resolveIcon(jid, iconName);
+		iconCache.insert(key, icon);
+		return icon;
+	}
+
+	PsiIcon *resolveIcon(const Jid &jid, const QString &iconName) const
 	{
 		// first level -- global default icon
 		PsiIcon *icon = (PsiIcon *)IconsetFactory::iconPtr(iconName);
 
 		// second level -- transport icon
-		if ( jid.node().isEmpty() || PsiOptions::instance()->getOption("options.ui.contactlist.use-transport-icons").toBool() ) {
-			QMap<QString, QRegExp> services;
-			services["aim"]		= QRegExp("^aim");
-			services["gadugadu"]	= QRegExp("^gg");
-			services["icq"]		= QRegExp("^icq");
-			services["msn"]		= QRegExp("^msn");
-			services["yahoo"]	= QRegExp("^yahoo");
-			services["sms"]		= QRegExp("^sms");
-
+		if ( jid.node().isEmpty() || useTransportIcons ) {
 			bool found = false;
 
-			
-			foreach(QVariant serviceV, PsiOptions::instance()->mapKeyList("options.iconsets.service-status")) {
-				QString service = serviceV.toString();
-				if (services.contains(service)) {
-					if (services[service].indexIn(jid.domain()) != -1 ) {
-						const Iconset *is = psi->roster.value(
-								PsiOptions::instance()->getOption(
-								PsiOptions::instance()->mapLookup("options.iconsets.service-status", service)+".iconset").toString());
-						if ( is ) {
-							PsiIcon *i = (PsiIcon *)is->icon(iconName);
-							if ( i ) {
-								icon = i;
-								found = true;
-								break;
-							}
-						}
+			foreach(const IconRule &rule, serviceRules) {
+				if ( rule.rx.indexIn(jid.domain()) != -1 ) {
+					PsiIcon *i = (PsiIcon *)rule.iconset->icon(iconName);
+					if ( i ) {
+						icon = i;
+						found = true;
+						break;
 					}
 				}
 			}
-			
 
 			// let's try the default transport iconset then...
-			if ( !found && jid.node().isEmpty() ) {
-				if (PsiOptions::instance()->mapKeyList("options.iconsets.service-status").contains("transport")) {
-					const Iconset *is = psi->roster.value(
-								PsiOptions::instance()->getOption(
-								PsiOptions::instance()->mapLookup("options.iconsets.service-status", "transport")+".iconset").toString());			  
-					if ( is ) {
-						PsiIcon *i = (PsiIcon *)is->icon(iconName);
-						if ( i )
-							icon = i;
-					}
-				}
+			if ( !found && jid.node().isEmpty() && transportIconset ) {
+				PsiIcon *i = (PsiIcon *)transportIconset->icon(iconName);
+				if ( i )
+					icon = i;
 			}
 		}
 
 		// third level -- custom icons
-		
-		QStringList customicons = PsiOptions::instance()->getChildOptionNames("options.iconsets.custom-status", true, true);
-		foreach(QString base, customicons) {
-			QRegExp rx = QRegExp(PsiOptions::instance()->getOption(base + ".regexp").toString());
-			if ( rx.indexIn(jid.bare()) != -1 ) {
-				const Iconset *is = psi->roster.value(PsiOptions::instance()->getOption(base + ".iconset").toString());
-				if ( is ) {
-					PsiIcon *i = (PsiIcon *)is->icon(iconName);
-					if ( i )
-						icon = (PsiIcon *)is->icon(iconName);
-				}
+		foreach(const IconRule &rule, customRules) {
+			if ( rule.rx.indexIn(jid.bare()) != -1 ) {
+				PsiIcon *i = (PsiIcon *)rule.iconset->icon(iconName);
+				if ( i )
+					icon = i;
 			}
 		}
 
 		return icon;
 	}
 
+	// turns service-status and custom-status options into a rule table,
+	// so that jid2icon() doesn't need to query options on every call
+	void compileRules()
+	{
+		PsiOptions *o = PsiOptions::instance();
+		useTransportIcons = o->getOption("options.ui.contactlist.use-transport-icons").toBool();
+
+		QMap<QString, QRegExp> services;
+		services["aim"]		= QRegExp("^aim");
+		services["gadugadu"]	= QRegExp("^gg");
+		services["icq"]		= QRegExp("^icq");
+		services["msn"]		= QRegExp("^msn");
+		services["yahoo"]	= QRegExp("^yahoo");
+		services["sms"]		= QRegExp("^sms");
+
+		serviceRules.clear();
+		transportIconset = 0;
+		foreach(QVariant serviceV, o->mapKeyList("options.iconsets.service-status")) {
+			QString service = serviceV.toString();
+			const Iconset *is = psi->roster.value(
+					o->getOption(o->mapLookup("options.iconsets.service-status", service) + ".iconset").toString());
+			if ( !is )
+				continue;
+
+			if ( services.contains(service) ) {
+				IconRule rule;
+				rule.rx = services[service];
+				rule.iconset = is;
+				serviceRules += rule;
+			}
+			else if ( service == "transport" ) {
+				transportIconset = is;
+			}
+		}
+
+		customRules.clear();
+		foreach(QString base, o->getChildOptionNames("options.iconsets.custom-status", true, true)) {
+			const Iconset *is = psi->roster.value(o->getOption(base + ".iconset").toString());
+			if ( !is )
+				continue;
+
+			IconRule rule;
+			rule.rx = QRegExp(o->getOption(base + ".regexp").toString());
+			rule.iconset = is;
+			customRules += rule;
+		}
+
+		rulesValid = true;
+	}
+
+	void invalidateIcons()
+	{
+		rulesValid = false;
+		iconCache.clear();
+	}
+
 	Iconset systemIconset(bool *ok)
 	{
 		Iconset def;
@@ -279,6 +338,7 @@ bool PsiIconset::loadSystem()
 		d->system.addToFactory();
 
 		d->cur_system = cur_system;
+		d->invalidateIcons();
 	}
 
 	return ok;
@@ -336,6 +396,7 @@ bool PsiIconset::loadRoster()
 		}
 	}
 
+	d->invalidateIcons();
 	return ok;
 }
 
@@ -370,6 +431,10 @@ void PsiIconset::optionChanged(const QString& option)
 		loadEmoticons();
 	}
 
+	if (option.startsWith("options.iconsets.") || option == "options.ui.contactlist.use-transport-icons") {
+		d->invalidateIcons();
+	}
+
 	// currently we rely on PsiCon calling reloadRoster() when
 	// all options are already applied. otherwise we risk the chance
 	// being called too many times
@@ -476,6 +541,8 @@ void PsiIconset::reloadRoster()
 		d->cur_service_status = cur_service_status;
 		d->cur_custom_status  = cur_custom_status;
 	}
+
+	d->invalidateIcons();
 }
 
 PsiIcon *PsiIconset::event2icon(PsiEvent *e)
@@ -231,6 +231,8 @@ bool PsiOptions::exists(QString fileName) {
  */
 bool PsiOptions::load(QString file)
 {
+	if (loadSnapshot(snapshotFile(file), file, ApplicationInfo::version()))
+		return true;
 	return loadOptions(file, "options", ApplicationInfo::optionsNS());
 }
 
@@ -254,7 +256,21 @@ void PsiOptions::load(XMPP::Client* client)
  */
 bool PsiOptions::save(QString file)
 {
-	return saveOptions(file, "options", ApplicationInfo::optionsNS(), ApplicationInfo::version());
+	if (!saveOptions(file, "options", ApplicationInfo::optionsNS(), ApplicationInfo::version()))
+		return false;
+
+	saveSnapshot(snapshotFile(file), file, ApplicationInfo::version());
+	return true;
+}
+
+/**
+ * Name of the binary snapshot kept next to the xml config file \a file.
+ * load() prefers the snapshot as long as \a file wasn't touched since
+ * the snapshot was written.
+ */
+QString PsiOptions::snapshotFile(const QString &file)
+{
+	return file + ".snapshot";
 }
 
 PsiOptions::PsiOptions()
@@ -285,9 +301,9 @@ PsiOptions::~PsiOptions()
 {
 	// since we queue connection to saveToAutoFile, so if some option was saved prior
 	// to program termination, the PsiOptions is never given the chance to save
-	// the changed option
+	// the changed option. saveToAutoFile() also leaves the xml file alone.
 	if (!autoFile_.isEmpty()) {
-		saveToAutoFile();
+		save(autoFile_);
 	}
 }
 
@@ -315,7 +331,11 @@ void PsiOptions::autoSave(bool autoSave, QString autoFile)
 void PsiOptions::saveToAutoFile()
 {
 	if (!autoFile_.isEmpty()) {
-		save(autoFile_);
+		// only the snapshot is updated here, the xml file is written
+		// on exit. the snapshot stays valid as long as the xml file
+		// isn't changed behind our back.
+		if (!saveSnapshot(snapshotFile(autoFile_), autoFile_, ApplicationInfo::version()))
+			save(autoFile_);
 	}
 }
 
@@ -47,6 +47,7 @@ public:
 	bool newProfile();
 	bool save(QString file);
 	void autoSave(bool autoSave, QString autoFile = "");
+	static QString snapshotFile(const QString &file);
 
 // don't call this normally
 	PsiOptions();
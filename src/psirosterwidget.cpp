@@ -39,6 +39,7 @@
 #endif
 #include "psioptions.h"
 #include "contactlistutil.h"
+#include "contactlistsearchindex.h"
 #include "psiaccount.h"
 
 static const QString contactSortStyleOptionPath = "options.ui.contactlist.contact-sort-style";
@@ -57,35 +58,55 @@ class PsiRosterFilterProxyModel : public QSortFilterProxyModel
 {
 	Q_OBJECT
 public:
-	PsiRosterFilterProxyModel(QObject* parent)
+	PsiRosterFilterProxyModel(ContactListSearchIndex* searchIndex, QObject* parent)
 		: QSortFilterProxyModel(parent)
+		, searchIndex_(searchIndex)
 	{
 		sort(0, Qt::AscendingOrder);
 		setDynamicSortFilter(true);
-		setFilterCaseSensitivity(Qt::CaseInsensitive);
-		setSortLocaleAware(true);
+
+		connect(searchIndex_, SIGNAL(contactChanged(PsiContact*)), SLOT(contactChanged(PsiContact*)));
+		connect(searchIndex_, SIGNAL(contactRemoved(PsiContact*)), SLOT(contactRemoved(PsiContact*)));
+	}
+
+	/**
+	 * Shows contacts matching every word of \a text. If the words of
+	 * \a text extend the previous ones, only the previous matches are
+	 * checked again.
+	 */
+	void setFilterText(const QString& text)
+	{
+		QStringList words = ContactListSearchIndex::tokenize(text);
+
+		bool narrowing = !words_.isEmpty() && words.count() >= words_.count();
+		for (int i = 0; narrowing && i < words_.count(); ++i)
+			narrowing = words[i].startsWith(words_[i]);
+
+		if (narrowing) {
+			QSet<PsiContact*>::iterator it = matches_.begin();
+			while (it != matches_.end()) {
+				if (searchIndex_->matches(*it, words))
+					++it;
+				else
+					it = matches_.erase(it);
+			}
+		}
+		else {
+			matches_ = searchIndex_->search(words);
+		}
+
+		words_ = words;
+		invalidateFilter();
 	}
 
 protected:
 	// reimplemented
 	bool filterAcceptsRow(int sourceRow, const QModelIndex& sourceParent) const
 	{
+		// TODO: also check for vCard value
 		QModelIndex index = sourceModel()->index(sourceRow, 0, sourceParent);
-
-		QStringList data;
-		if (index.isValid()) {
-			// TODO: also check for vCard value
-			data
-				<< index.data(Qt::DisplayRole).toString()
-				<< index.data(ContactListModel::JidRole).toString();
-		}
-
-		foreach(QString str, data) {
-			if (str.contains(filterRegExp()))
-				return true;
-		}
-
-		return false;
+		PsiContact* contact = static_cast<ContactListModel*>(sourceModel())->contactFor(index);
+		return contact && matches_.contains(contact);
 	}
 
 	// reimplemented
@@ -97,6 +118,27 @@ protected:
 			return false;
 		return item1->item()->compare(item2->item());
 	}
+
+private slots:
+	// the models see these changes later, after their updater commits,
+	// and then filter the affected rows against the updated matches
+	void contactChanged(PsiContact* contact)
+	{
+		if (searchIndex_->matches(contact, words_))
+			matches_ += contact;
+		else
+			matches_.remove(contact);
+	}
+
+	void contactRemoved(PsiContact* contact)
+	{
+		matches_.remove(contact);
+	}
+
+private:
+	ContactListSearchIndex* searchIndex_;
+	QStringList words_;
+	QSet<PsiContact*> matches_;
 };
 
 //----------------------------------------------------------------------------
@@ -193,7 +235,7 @@ void PsiRosterWidget::setContactList(PsiContactList* contactList)
 	contactListPageView_->setModel(contactListProxyModel);
 
 	{
-		filterModel_ = new PsiRosterFilterProxyModel(this);
+		filterModel_ = new PsiRosterFilterProxyModel(new ContactListSearchIndex(contactList_, this), this);
 
 		ContactListModel* clone = contactListModel_->clone();
 		clone->setGroupsEnabled(false);
@@ -301,7 +343,7 @@ void PsiRosterWidget::setShowStatusMsg(bool enabled)
 void PsiRosterWidget::filterEditTextChanged(const QString& text)
 {
 	updateFilterMode();
-	filterModel_->setFilterRegExp(QString("^%1|[@]%1|\\s%1").arg(QRegExp::escape(text)));
+	filterModel_->setFilterText(text);
 }
 
 void PsiRosterWidget::quitFilteringMode()
@@ -31,7 +31,7 @@ class PsiContactListView;
 class QStackedWidget;
 class QMimeData;
 class QLineEdit;
-class QSortFilterProxyModel;
+class PsiRosterFilterProxyModel;
 class PsiFilteredContactListView;
 
 class PsiRosterWidget : public QWidget
@@ -74,7 +74,7 @@ private:
 	QLineEdit* filterEdit_;
 
 	PsiContactListModel* contactListModel_;
-	QSortFilterProxyModel* filterModel_;
+	PsiRosterFilterProxyModel* filterModel_;
 };
 
 #endif
@@ -127,6 +127,7 @@ HEADERS += \
 	$$PWD/infodlg.h \
 	$$PWD/translationmanager.h \
 	$$PWD/eventdb.h \
+	$$PWD/edbpage.h \
 	$$PWD/historydlg.h \
 	$$PWD/tipdlg.h \
 	$$PWD/searchdlg.h \
@@ -255,6 +256,7 @@ SOURCES += \
 	$$PWD/infodlg.cpp \
 	$$PWD/translationmanager.cpp \
 	$$PWD/eventdb.cpp \
+	$$PWD/edbpage.cpp \
 	$$PWD/historydlg.cpp \
 	$$PWD/searchdlg.cpp \
 	$$PWD/registrationdlg.cpp \
@@ -320,10 +322,16 @@ filetransfer {
 	DEFINES += FILETRANSFER
 
 	HEADERS += \
-		$$PWD/filetransdlg.h
+		$$PWD/filetransdlg.h \
+		$$PWD/filereadahead.h \
+		$$PWD/filewritebehind.h \
+		$$PWD/filetransferstats.h
 
 	SOURCES += \
-		$$PWD/filetransdlg.cpp
+		$$PWD/filetransdlg.cpp \
+		$$PWD/filereadahead.cpp \
+		$$PWD/filewritebehind.cpp \
+		$$PWD/filetransferstats.cpp
 
 	FORMS += \
 		$$PWD/filetrans.ui
@@ -336,11 +344,13 @@ groupchat {
 	HEADERS += \
 		$$PWD/groupchatdlg.h \
 		$$PWD/gcuserview.h \
+		$$PWD/gchighlighter.h \
 		$$PWD/mucjoindlg.h
 
 	SOURCES += \
 		$$PWD/groupchatdlg.cpp \
 		$$PWD/gcuserview.cpp \
+		$$PWD/gchighlighter.cpp \
 		$$PWD/mucjoindlg.cpp
 
 	FORMS += \
@@ -406,6 +416,7 @@ newcontactlist {
 		$$PWD/contactlistdragview.h \
 		$$PWD/hoverabletreeview.h \
 		$$PWD/contactlistmodel.h \
+		$$PWD/contactlistrowsnapshot.h \
 		$$PWD/contactlistmodelselection.h \
 		$$PWD/contactlistdragmodel.h \
 		$$PWD/contactlistviewdelegate.h \
@@ -425,6 +436,7 @@ newcontactlist {
 		$$PWD/contactlistitem.h \
 		$$PWD/contactlistitemmenu.h \
 		$$PWD/contactlistutil.h \
+		$$PWD/contactlistsearchindex.h \
 		$$PWD/contactlistitemproxy.h \
 		$$PWD/contactupdatesmanager.h \
 		$$PWD/statusmenu.h \
@@ -455,6 +467,7 @@ newcontactlist {
 		$$PWD/contactlistitem.cpp \
 		$$PWD/contactlistitemmenu.cpp \
 		$$PWD/contactlistutil.cpp \
+		$$PWD/contactlistsearchindex.cpp \
 		$$PWD/contactlistitemproxy.cpp \
 		$$PWD/contactupdatesmanager.cpp \
 		$$PWD/statusmenu.cpp \
@@ -473,16 +486,6 @@ newcontactlist {
 			$$PWD/psicontactlistmodel.cpp
 	}
 }
-!newcontactlist {
-	QT += qt3support
-	HEADERS += \
-		$$PWD/legacypsiaccount.h \
-		$$PWD/contactview.h
-
-	SOURCES += \
-		$$PWD/legacypsiaccount.cpp \
-		$$PWD/contactview.cpp
-}
 
 CONFIG += pgputil
 pgputil {
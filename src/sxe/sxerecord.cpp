@@ -20,6 +20,8 @@
 
 #include "sxerecord.h"
 
+#include <QSet>
+
 
 static bool referencedEditLessThan(const SxeEdit* e1, const SxeEdit* e2) { return *e1 < *e2; }
 
@@ -64,6 +66,56 @@ QList<const SxeEdit*> SxeRecord::edits() const {
 	return edits;
 };
 
+QList<const SxeEdit*> SxeRecord::compactedEdits(QList<SxeEdit*> &owned) const {
+	QList<const SxeEdit*> edits;
+	for(int i = 0; i < edits_.size(); i++)
+		edits.append(edits_[i]);
+
+	// Walk backwards collecting the keys that are fully set by an edit
+	// that actually took effect. Earlier edits touching only those keys
+	// make no difference to the end result.
+	QSet<SxeRecordEdit::Key> overridden;
+	for(int i = edits_.size() - 1; i > 0; i--) {
+		if(edits_[i]->type() != SxeEdit::Record)
+			continue;
+
+		const SxeRecordEdit* edit = dynamic_cast<const SxeRecordEdit*>(edits_[i]);
+		bool effective = (i == edit->version() && (i+1 == edits_.size() || !edit->overridenBy(*edits_[i+1])));
+		if(!effective)
+			continue;
+
+		QList<SxeRecordEdit::Key> keys = edit->keys();
+		bool partial = keys.contains(SxeRecordEdit::ReplaceFrom) || keys.contains(SxeRecordEdit::ReplaceN);
+
+		bool redundant = true;
+		foreach(SxeRecordEdit::Key key, keys) {
+			if(key == SxeRecordEdit::ReplaceFrom || key == SxeRecordEdit::ReplaceN)
+				continue;
+			if(!overridden.contains(key)) {
+				redundant = false;
+				break;
+			}
+		}
+
+		if(redundant && !keys.isEmpty()) {
+			SxeRecordEdit* placeholder = new SxeRecordEdit(rid_, edit->version(), QHash<SxeRecordEdit::Key, QString>(), edit->remote());
+			owned.append(placeholder);
+			edits[i] = placeholder;
+			continue;
+		}
+
+		// a partial replace depends on the preceding value
+		foreach(SxeRecordEdit::Key key, keys) {
+			if(key == SxeRecordEdit::ReplaceFrom || key == SxeRecordEdit::ReplaceN)
+				continue;
+			if(!partial || (key != SxeRecordEdit::Chdata && key != SxeRecordEdit::ProcessingInstructionData))
+				overridden.insert(key);
+		}
+	}
+
+	return edits;
+}
+
 bool SxeRecord::applySxeNewEdit(QDomDocument &doc, SxeNewEdit* edit) {
 	if(!(edits_.size() == 0 && node_.isNull())) {
 		qDebug("Someone's not behaving! Tried to apply a SxeNewEdit to an existing node.");
@@ -43,6 +43,12 @@ class SxeRecord : public QObject {
 		void apply(QDomDocument &doc, SxeEdit* edit);
 		/*! \brief Returns a list of edits to the node.*/
 		QList<const SxeEdit*> edits() const;
+		/*! \brief Returns the edits to the node with every record edit that is
+		 *  completely overridden by later edits replaced by an empty one.
+		 *  The versions stay intact. The replacements are appended to \a owned
+		 *  and are to be deleted by the caller.
+		 */
+		QList<const SxeEdit*> compactedEdits(QList<SxeEdit*> &owned) const;
 		/*! \brief Returns the rid of the node that the record belongs to. */
 		QString rid() const;
 		/*! \brief Returns the rid of the parent.*/
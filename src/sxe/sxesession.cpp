@@ -26,6 +26,8 @@
 
 // The maxlength of a chdata that gets put in one edit
 enum {MAXCHDATA = 1024};
+// The number of processed <sxe/> ids remembered for detecting duplicates
+enum {MAXUSEDSXEIDS = 4096};
 
 using namespace XMPP;
 
@@ -53,7 +55,9 @@ SxeSession::SxeSession(SxeManager *manager, const Jid &target, const QString &se
 SxeSession::~SxeSession() {
 	qDebug("destruct SxeSession");
 	qDeleteAll(recordByNodeId_);
-	recordByNodeId_.clear();
+	clearRecords();
+	qDeleteAll(snapshot_);
+	snapshot_.clear();
 	emit sessionEnded(this);
 }
 
@@ -66,8 +70,7 @@ void SxeSession::initializeDocument(const QDomDocument &doc) {
 	doc_ = QDomDocument();
 	foreach(SxeRecord* meta, recordByNodeId_.values())
 		meta->deleteLater();
-	// recordByNode_.clear();
-	recordByNodeId_.clear();
+	clearRecords();
 	queuedIncomingEdits_.clear();
 	queuedOutgoingEdits_.clear();
 
@@ -99,13 +102,13 @@ void SxeSession::processIncomingSxeElement(const QDomElement &sxe, const QString
 
 bool SxeSession::processSxe(const QDomElement &sxe, const QString &id) {
 	// Don't accept duplicates
-	if(!id.isEmpty() && usedSxeIds_.contains(id)) {
+	if(!id.isEmpty() && usedSxeIdSet_.contains(id)) {
 		qDebug() << QString("Tried to process a duplicate %1 (received: %2).").arg(sxe.attribute("id")).arg(usedSxeIds_.size()).toAscii();
 		return false;
 	}
 
 	if(!id.isEmpty())
-		usedSxeIds_ += id;
+		addUsedSxeId(id);
 
 	// store incoming edits when queueing
 	if(queueing_) {
@@ -185,40 +188,47 @@ QList<const SxeEdit*> SxeSession::startQueueing() {
 	queueing_ = true;
 
 	// Return all the effective Edits to the session so far (snapshot)
-	// make sure that they are added in the right order (parents first)
+	// make sure that they are added in the right order (parents first).
+	// childrenByParent_ is kept up to date as records change so this is
+	// proportional to the size of the document.
 	QString rootid;
 	QList<const SxeEdit*> nonDocElementEdits;
-	QMultiHash<QString, QString> ridByParent;
 
-	// first collect all nodes into a hash by their parent
-	foreach(SxeRecord* m, recordByNodeId_.values()) {
-		if(!m->parent().isEmpty()) {
-			ridByParent.insert(m->parent(), m->rid());
-		} else if(!m->node().isElement()) {
-			nonDocElementEdits += m->edits();
-		} else
-			rootid = m->rid();
+	foreach(QString rid, childrenByParent_.value(QString())) {
+		SxeRecord* m = recordByNodeId_.value(rid);
+		if(!m)
+			continue;
+
+		if(!m->node().isElement())
+			nonDocElementEdits += m->compactedEdits(snapshot_);
+		else
+			rootid = rid;
 	}
 
 	// starting from the root, add all edits to a list recursively
 	QList<const SxeEdit*> edits;
+	QSet<QString> visited;
 
 	if(!rootid.isNull())
-		arrangeEdits(ridByParent, edits, rootid);
+		arrangeEdits(visited, edits, rootid);
 
 	return nonDocElementEdits + edits;
 }
 
-void SxeSession::arrangeEdits(QHash<QString, QString> &ridByParent, QList<const SxeEdit*> &output, const QString &iterator) {
+void SxeSession::arrangeEdits(QSet<QString> &visited, QList<const SxeEdit*> &output, const QString &iterator) {
+	// guard against records that are (transiently) their own ancestors
+	if(visited.contains(iterator))
+		return;
+	visited.insert(iterator);
+
 	// add the edits to this node
-	if(recordByNodeId_.contains(iterator))
-		output += recordByNodeId_.value(iterator)->edits();
+	SxeRecord* meta = recordByNodeId_.value(iterator);
+	if(meta)
+		output += meta->compactedEdits(snapshot_);
 
 	// process all the children
-	QString child;
-	while(!(child = ridByParent.take(iterator)).isNull()) {
-		arrangeEdits(ridByParent, output, child);
-	}
+	foreach(QString child, childrenByParent_.value(iterator))
+		arrangeEdits(visited, output, child);
 }
 
 void SxeSession::stopQueueing() {
@@ -228,6 +238,10 @@ void SxeSession::stopQueueing() {
 
 	queueing_ = false;
 
+	// the snapshot has been sent by now
+	qDeleteAll(snapshot_);
+	snapshot_.clear();
+
 	// Process queued elements
 	flush();
 
@@ -646,12 +660,20 @@ void SxeSession::reposition(const QDomNode &node, bool remote) {
 // }
 
 void SxeSession::handleNodeToBeAdded(const QDomNode &node, bool remote) {
+	SxeRecord* meta = qobject_cast<SxeRecord*>(sender());
+	if(meta)
+		indexRecord(meta);
+
 	emit nodeToBeAdded(node, remote);
 	reposition(node, remote);
 	emit nodeAdded(node, remote);
 }
 
 void SxeSession::handleNodeToBeMoved(const QDomNode &node, bool remote) {
+	SxeRecord* meta = qobject_cast<SxeRecord*>(sender());
+	if(meta)
+		indexRecord(meta);
+
 	emit nodeToBeMoved(node, remote);
 	reposition(node, remote);
 	emit nodeMoved(node, remote);
@@ -659,7 +681,14 @@ void SxeSession::handleNodeToBeMoved(const QDomNode &node, bool remote) {
 
 void SxeSession::handleNodeToBeRemoved(const QDomNode &node, bool remote) {
 	emit nodeToBeRemoved(node, remote);
-	removeRecord(node);
+
+	// the record is the sender, so avoid looking it up by node
+	SxeRecord* meta = qobject_cast<SxeRecord*>(sender());
+	if(meta && recordByNodeId_.value(meta->rid()) == meta) {
+		unindexRecord(meta);
+		recordByNodeId_.remove(meta->rid());
+	} else
+		removeRecord(node);
 }
 
 
@@ -668,12 +697,45 @@ void SxeSession::removeRecord(const QDomNode &node) {
 
 	while(i.hasNext()) {
 		if(node == i.next().value()->node()) {
+			unindexRecord(i.value());
 			i.remove();
 			return;
 		}
 	}
 }
 
+void SxeSession::indexRecord(SxeRecord* meta) {
+	QHash<SxeRecord*, QString>::iterator it = indexedParent_.find(meta);
+	if(it != indexedParent_.end()) {
+		if(it.value() == meta->parent())
+			return;
+		childrenByParent_[it.value()].remove(meta->rid());
+	}
+
+	indexedParent_[meta] = meta->parent();
+	childrenByParent_[meta->parent()].insert(meta->rid());
+}
+
+void SxeSession::unindexRecord(SxeRecord* meta) {
+	QHash<SxeRecord*, QString>::iterator it = indexedParent_.find(meta);
+	if(it == indexedParent_.end())
+		return;
+
+	QHash<QString, QSet<QString> >::iterator siblings = childrenByParent_.find(it.value());
+	if(siblings != childrenByParent_.end()) {
+		siblings.value().remove(meta->rid());
+		if(siblings.value().isEmpty())
+			childrenByParent_.erase(siblings);
+	}
+	indexedParent_.erase(it);
+}
+
+void SxeSession::clearRecords() {
+	recordByNodeId_.clear();
+	childrenByParent_.clear();
+	indexedParent_.clear();
+}
+
 bool SxeSession::removeSmaller(SxeRecord* meta1, SxeRecord* meta2) {
 	if(!meta1)
 		return true;
@@ -692,7 +754,15 @@ bool SxeSession::removeSmaller(SxeRecord* meta1, SxeRecord* meta2) {
 }
 
 void SxeSession::addUsedSxeId(QString id) {
-	usedSxeIds_ += id;
+	if(usedSxeIdSet_.contains(id))
+		return;
+
+	usedSxeIds_.enqueue(id);
+	usedSxeIdSet_.insert(id);
+
+	// duplicates only arrive shortly after the original, so old ids can be forgotten
+	while(usedSxeIds_.size() > MAXUSEDSXEIDS)
+		usedSxeIdSet_.remove(usedSxeIds_.dequeue());
 }
 
 QList<QString> SxeSession::usedSxeIds() {
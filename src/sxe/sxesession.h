@@ -26,6 +26,8 @@
 
 #include <QObject>
 #include <QList>
+#include <QQueue>
+#include <QSet>
 #include <QPointer>
 #include <QDomNode>
 #include "im.h"
@@ -87,6 +89,7 @@ class SxeSession : public QObject {
 
 		/*! \brief Starts queueing new edits to the document.
 		 *  Queueing should be started just before sending <document-begin/>.
+		 *  Returns a compacted snapshot of the document that stays valid until stopQueueing().
 		 */
 		QList<const SxeEdit*> startQueueing();
 		/*! \brief Stop queueing new edits to the document and process the queued ones.
@@ -103,9 +106,11 @@ class SxeSession : public QObject {
 		 */
 		void stopImporting();
 
-		/*! \brief Add the given ID to the list of used IDs for <sxe/> elements.*/
+		/*! \brief Add the given ID to the list of used IDs for <sxe/> elements.
+		 *  Only the most recent MAXUSEDSXEIDS ids are remembered.
+		 */
 		void addUsedSxeId(QString id);
-		/*! \brief Return the list of used IDs for <sxe/> elements.*/
+		/*! \brief Return the list of used IDs for <sxe/> elements, oldest first.*/
 		QList<QString> usedSxeIds();
 
 		void setUUIDPrefix(const QString uuidPrefix = QString());
@@ -184,6 +189,12 @@ class SxeSession : public QObject {
 		void reposition(const QDomNode &node, bool remote);
 		/*! \brief Remove the record associated with \a node from the lookup tables. */
 		void removeRecord(const QDomNode &node);
+		/*! \brief Files \a meta under its current parent in childrenByParent_. */
+		void indexRecord(SxeRecord* meta);
+		/*! \brief Removes \a meta from childrenByParent_. */
+		void unindexRecord(SxeRecord* meta);
+		/*! \brief Clears all the lookup tables. Doesn't delete the records. */
+		void clearRecords();
 		/*! \brief Remove the item with smaller secondary weight.
 			Returns true iff \a meta1 was removed. */
 		bool removeSmaller(SxeRecord* meta1, SxeRecord* meta2);
@@ -203,7 +214,7 @@ class SxeSession : public QObject {
 		/*! \brief Generates SxeRemoveEdits for \a node and its children. */
 		void generateRemoves(const QDomNode &node);
 		/*! \brief Recursive helper method for arranging edits for the snapshot. */
-		void arrangeEdits(QHash<QString, QString> &ridByParent, QList<const SxeEdit*> &output, const QString &iterator);
+		void arrangeEdits(QSet<QString> &visited, QList<const SxeEdit*> &output, const QString &iterator);
 		/*! \brief Insert node with the given primaryWeight.
 		 *  Returns node if the node was already in the document. Otherwise returns the created node. */
 		const QDomNode insertNode(const QDomNode &node, const QString &parentId, double primaryWeight);
@@ -225,11 +236,17 @@ class SxeSession : public QObject {
 				QString,
 				SxeRecord*
 			 > recordByNodeId_;
+		/*! \brief Rids of the records grouped by the rid of their parent.
+		 *  Top level nodes are found under the null string.
+		 */
+		QHash<QString, QSet<QString> > childrenByParent_;
+		/*! \brief The parent each record is currently filed under in childrenByParent_.*/
+		QHash<SxeRecord*, QString> indexedParent_;
 		/*! \brief List of queued incoming sxe elements.*/
 		QList<IncomingEdit> queuedIncomingEdits_;
 		/*! \brief List of queued outgoing sxe elements.*/
 		QList<QDomNode> queuedOutgoingEdits_;
-		/*! \brief QDomDocument representing the the contents when queueing_ was set true.*/
+		/*! \brief Placeholder edits created for the snapshot returned by startQueueing().*/
 		QList<SxeEdit*> snapshot_;
 		/*! \brief True if the target is a groupchat.*/
 		bool groupChat_;
@@ -241,8 +258,10 @@ class SxeSession : public QObject {
 		bool importing_;
 		/*! \brief A list of supported features for the session.*/
 		QList<QString> features_;
-		 /*! \brief Identifiers for the <sxe/> elements that have been processed already.*/
-		QList<QString> usedSxeIds_;
+		/*! \brief Identifiers for the <sxe/> elements that have been processed already, oldest first.*/
+		QQueue<QString> usedSxeIds_;
+		/*! \brief The same identifiers as usedSxeIds_ for constant time lookups.*/
+		QSet<QString> usedSxeIdSet_;
 		/*! \brief A unique id is generated as "uuidPrefix.counter".*/
 		QString uuidPrefix_;
 		int uuidMaxPostfix_;
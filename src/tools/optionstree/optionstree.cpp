@@ -23,16 +23,47 @@
 #include <QDomElement>
 #include <QDomDocument>
 #include <QStringList>
+#include <QFile>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QDataStream>
+#include <QMetaObject>
+#include <QPointer>
+#include <QTimer>
 
 #include "atomicxmlfile/atomicxmlfile.h"
 #include "optionstreereader.h"
 #include "optionstreewriter.h"
 
+/**
+ * \brief One level of the option path trie used by subscribe()
+ */
+class OptionsTree::SubscriptionNode
+{
+public:
+	class Subscription
+	{
+	public:
+		QObject* receiver;
+		QByteArray method;
+		bool wantsNames;
+	};
+
+	~SubscriptionNode()
+	{
+		qDeleteAll(children);
+	}
+
+	QHash<QString, SubscriptionNode*> children;
+	QList<Subscription> subscriptions;
+};
+
 /**
  * Default constructor
  */
 OptionsTree::OptionsTree(QObject *parent)
 	: QObject(parent)
+	, subscriptions_(new SubscriptionNode)
 {
 	
 }
@@ -42,7 +73,7 @@ OptionsTree::OptionsTree(QObject *parent)
  */
 OptionsTree::~OptionsTree()
 {
-	
+	delete subscriptions_;
 }
 
 /**
@@ -86,6 +117,165 @@ void OptionsTree::setOption(const QString& name, const QVariant& value)
 		emit optionInserted(name);
 	}
 	emit optionChanged(name);
+
+	if (!subscribers_.isEmpty() && !pendingSet_.contains(name)) {
+		if (pendingChanges_.isEmpty())
+			QTimer::singleShot(0, this, SLOT(deliverChanges()));
+		pendingChanges_ += name;
+		pendingSet_ += name;
+	}
+}
+
+/**
+ * \brief Calls \a member of \a receiver when options under \a prefix change.
+ * Unlike optionChanged(), which is emitted for every single change to
+ * every listener, changes are collected and delivered once per event
+ * loop iteration, and only to the receivers subscribed to a prefix of
+ * the changed option's name. \a prefix matches whole name components,
+ * so "options.ui.chat" matches "options.ui.chat.font" but not
+ * "options.ui.chatlog".
+ *
+ * \a member is given with SLOT() and either takes no arguments or
+ * a const QStringList& with the names of all changed options.
+ * Subscriptions are removed automatically when \a receiver is destroyed.
+ */
+void OptionsTree::subscribe(const QString& prefix, QObject* receiver, const char* member)
+{
+	Q_ASSERT(receiver && member);
+	// skip the SLOT() code
+	QByteArray signature = QMetaObject::normalizedSignature(member + 1);
+	int index = receiver->metaObject()->indexOfMethod(signature);
+	if (index == -1) {
+		qWarning("OptionsTree::subscribe: no such slot %s::%s", receiver->metaObject()->className(), signature.constData());
+		return;
+	}
+
+	SubscriptionNode* node = subscriptions_;
+	if (!prefix.isEmpty()) {
+		foreach(const QString& part, prefix.split('.')) {
+			SubscriptionNode* child = node->children.value(part);
+			if (!child) {
+				child = new SubscriptionNode;
+				node->children.insert(part, child);
+			}
+			node = child;
+		}
+	}
+
+	SubscriptionNode::Subscription subscription;
+	subscription.receiver = receiver;
+	subscription.method = signature.left(signature.indexOf('('));
+	subscription.wantsNames = !signature.endsWith("()");
+	node->subscriptions += subscription;
+
+	if (!subscribers_.contains(receiver))
+		connect(receiver, SIGNAL(destroyed(QObject*)), SLOT(subscriberDestroyed(QObject*)));
+	subscribers_[receiver]++;
+}
+
+/**
+ * \brief Removes all subscriptions of \a receiver.
+ */
+void OptionsTree::unsubscribe(QObject* receiver)
+{
+	if (!subscribers_.remove(receiver))
+		return;
+	disconnect(receiver, SIGNAL(destroyed(QObject*)), this, SLOT(subscriberDestroyed(QObject*)));
+	unsubscribe(subscriptions_, receiver);
+}
+
+/**
+ * Removes subscriptions of \a receiver from \a node and its children,
+ * pruning nodes left empty. Returns true if \a node itself is empty now.
+ */
+bool OptionsTree::unsubscribe(SubscriptionNode* node, QObject* receiver)
+{
+	QMutableListIterator<SubscriptionNode::Subscription> it(node->subscriptions);
+	while (it.hasNext()) {
+		if (it.next().receiver == receiver)
+			it.remove();
+	}
+
+	QMutableHashIterator<QString, SubscriptionNode*> child(node->children);
+	while (child.hasNext()) {
+		child.next();
+		if (unsubscribe(child.value(), receiver)) {
+			delete child.value();
+			child.remove();
+		}
+	}
+
+	return node->subscriptions.isEmpty() && node->children.isEmpty();
+}
+
+void OptionsTree::subscriberDestroyed(QObject* receiver)
+{
+	if (subscribers_.remove(receiver))
+		unsubscribe(subscriptions_, receiver);
+}
+
+/**
+ * Changed option names collected for one subscribed slot.
+ */
+class OptionsTreeDelivery
+{
+public:
+	QPointer<QObject> receiver;
+	QByteArray method;
+	bool wantsNames;
+	QStringList names;
+};
+
+/**
+ * Walks the path of every option changed since the last call down the
+ * subscription trie, and calls each subscribed slot once with all the
+ * names that matched it.
+ */
+void OptionsTree::deliverChanges()
+{
+	QStringList changes = pendingChanges_;
+	pendingChanges_.clear();
+	pendingSet_.clear();
+
+	QList<OptionsTreeDelivery> deliveries;
+	QHash<QPair<QObject*, QByteArray>, int> deliveryIndex;
+	foreach(const QString& name, changes) {
+		SubscriptionNode* node = subscriptions_;
+		QStringList parts = name.split('.');
+		for (int i = 0; node; ++i) {
+			foreach(const SubscriptionNode::Subscription& subscription, node->subscriptions) {
+				QPair<QObject*, QByteArray> key(subscription.receiver, subscription.method);
+				QHash<QPair<QObject*, QByteArray>, int>::const_iterator it = deliveryIndex.find(key);
+				if (it == deliveryIndex.end()) {
+					OptionsTreeDelivery delivery;
+					delivery.receiver = subscription.receiver;
+					delivery.method = subscription.method;
+					delivery.wantsNames = subscription.wantsNames;
+					it = deliveryIndex.insert(key, deliveries.count());
+					deliveries += delivery;
+				}
+
+				// receiver could be subscribed to both a prefix and its parent
+				QStringList& names = deliveries[it.value()].names;
+				if (names.isEmpty() || names.last() != name)
+					names += name;
+			}
+
+			if (i == parts.count())
+				break;
+			node = node->children.value(parts.at(i));
+		}
+	}
+
+	foreach(const OptionsTreeDelivery& delivery, deliveries) {
+		// earlier slots may have destroyed later receivers
+		if (delivery.receiver.isNull())
+			continue;
+		if (delivery.wantsNames)
+			QMetaObject::invokeMethod(delivery.receiver, delivery.method.constData(), Q_ARG(QStringList, delivery.names));
+		else
+			QMetaObject::invokeMethod(delivery.receiver, delivery.method.constData());
+	}
 }
 
 
@@ -156,11 +346,9 @@ bool OptionsTree::isValidName(const QString &name)
 
 QString OptionsTree::mapLookup(const QString &basename, const QVariant &key) const
 {
-	QStringList children = getChildOptionNames( basename, true, true);
-	foreach (QString path, children) {
-		if (getOption(path+".key") == key) {
-			return path;
-		}
+	QString child = tree_.mapLookup(basename, key);
+	if (!child.isNull()) {
+		return basename + '.' + child;
 	}
 	qWarning("Accessing missing key '%s' in option map '%s'", qPrintable(key.toString()), qPrintable(basename));
 	return basename + "XXX";
@@ -171,9 +359,9 @@ QVariant OptionsTree::mapGet(const QString &basename, const QVariant &key, const
 }
 
 QVariant OptionsTree::mapGet(const QString &basename, const QVariant &key, const QString &node, const QVariant &def) const {
-	QVariantList keys = mapKeyList(basename);
-	if (keys.contains(key)) {
-		return getOption(mapLookup(basename, key) + '.' + node);
+	QString child = tree_.mapLookup(basename, key);
+	if (!child.isNull()) {
+		return getOption(basename + '.' + child + '.' + node);
 	} else {
 		return def;
 	}
@@ -182,21 +370,13 @@ QVariant OptionsTree::mapGet(const QString &basename, const QVariant &key, const
 
 QString OptionsTree::mapPut(const QString &basename, const QVariant &key)
 {
-	QStringList children = getChildOptionNames( basename, true, true);
-	foreach (QString path, children) {
-		if (getOption(path+".key") == key) {
-			return path;
-		}
+	QString child = tree_.mapLookup(basename, key);
+	if (!child.isNull()) {
+		return basename + '.' + child;
 	}
-	// FIXME performance?
-	
+
 	// allocate first unused index
-	QString path;
-	int i = 0;
-	do {
-		path = basename+".m"+QString::number(i);
-		++i;
-	} while (children.contains(path));
+	QString path = basename + '.' + tree_.mapFreeChildName(basename);
 	setOption(path + ".key", key);
 	return path;	
 }
@@ -207,15 +387,85 @@ void OptionsTree::mapPut(const QString &basename, const QVariant &key, const QSt
 
 QVariantList OptionsTree::mapKeyList(const QString &basename) const
 {
-	QVariantList ret;
-	QStringList children = getChildOptionNames( basename, true, true);
-	foreach (QString path, children) {
-		ret << getOption(path+".key");
+	return tree_.mapKeyList(basename);
+}
+
+
+
+// binary snapshot header
+static const quint32 snapshotMagic = 0x5073694f; // "PsiO"
+static const quint32 snapshotFormat = 1;
+
+/**
+ * Saves all options to a binary snapshot.
+ * The snapshot remembers size and modification time of \a sourceFile and
+ * \a configVersion, and loadSnapshot() refuses it if either has changed.
+ * \return 'true' if the snapshot was written
+ */
+bool OptionsTree::saveSnapshot(const QString& fileName, const QString& sourceFile, const QString& configVersion) const
+{
+	QFileInfo source(sourceFile);
+	if (!source.exists())
+		return false;
+
+	QByteArray data;
+	QDataStream out(&data, QIODevice::WriteOnly);
+	out.setVersion(QDataStream::Qt_4_6);
+	out << snapshotMagic << snapshotFormat << configVersion
+	    << qint64(source.size()) << quint32(source.lastModified().toTime_t());
+	if (!tree_.toBinary(out))
+		return false;
+
+	// write next to the old snapshot and swap them, so there's never
+	// a half-written snapshot in place
+	QString tmpName = fileName + ".new";
+	QFile f(tmpName);
+	if (!f.open(QIODevice::WriteOnly | QIODevice::Truncate))
+		return false;
+	bool ok = f.write(data) == data.size();
+	f.close();
+	if (ok) {
+		QFile::remove(fileName);
+		ok = QFile::rename(tmpName, fileName);
 	}
-	return ret;
+	if (!ok)
+		QFile::remove(tmpName);
+	return ok;
 }
 
+/**
+ * Loads options from a binary snapshot written by saveSnapshot(), in the
+ * same way loadOptions() adds them to the existing ones.
+ * \return 'false' if the snapshot is missing, damaged, or \a sourceFile
+ * or \a configVersion don't match the snapshot anymore
+ */
+bool OptionsTree::loadSnapshot(const QString& fileName, const QString& sourceFile, const QString& configVersion)
+{
+	QFileInfo source(sourceFile);
+	QFile f(fileName);
+	if (!source.exists() || !f.open(QIODevice::ReadOnly))
+		return false;
+
+	QByteArray data = f.readAll();
+	f.close();
+
+	QDataStream in(data);
+	in.setVersion(QDataStream::Qt_4_6);
+	quint32 magic, format, mtime;
+	qint64 size;
+	QString version;
+	in >> magic >> format >> version >> size >> mtime;
+	if (in.status() != QDataStream::Ok || magic != snapshotMagic || format != snapshotFormat
+	    || version != configVersion || size != source.size() || mtime != source.lastModified().toTime_t())
+		return false;
+
+	VariantTree tree;
+	if (!tree.fromBinary(in))
+		return false;
 
+	tree_.merge(tree);
+	return true;
+}
 
 /**
  * Saves all options to the specified file
@@ -21,6 +21,9 @@
 #ifndef OPTIONSTREE_H
 #define OPTIONSTREE_H
 
+#include <QSet>
+#include <QStringList>
+
 #include "varianttree.h"
 
 /**
@@ -62,6 +65,12 @@ public:
 	bool loadOptions(const QDomElement& name, const QString& configName, const QString& configNS = "", const QString& configVersion = "");
 	static bool exists(QString fileName);
 
+	bool saveSnapshot(const QString& fileName, const QString& sourceFile, const QString& configVersion) const;
+	bool loadSnapshot(const QString& fileName, const QString& sourceFile, const QString& configVersion);
+
+	void subscribe(const QString& prefix, QObject* receiver, const char* member);
+	void unsubscribe(QObject* receiver);
+
 signals:
 	void optionChanged(const QString& option);
 	void optionAboutToBeInserted(const QString& option);
@@ -69,8 +78,20 @@ signals:
 	void optionAboutToBeRemoved(const QString& option);
 	void optionRemoved(const QString& option);
 
+private slots:
+	void deliverChanges();
+	void subscriberDestroyed(QObject* receiver);
+
 private:
+	class SubscriptionNode;
+
 	VariantTree tree_;
+	SubscriptionNode* subscriptions_;
+	QHash<QObject*, int> subscribers_;
+	QStringList pendingChanges_;
+	QSet<QString> pendingSet_;
+
+	static bool unsubscribe(SubscriptionNode* node, QObject* receiver);
 	friend class OptionsTreeReader;
 	friend class OptionsTreeWriter;
 };
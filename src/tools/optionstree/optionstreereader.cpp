@@ -47,13 +47,13 @@ void OptionsTreeReader::readTree(VariantTree* tree)
 
 			if (attributes().value("type").isEmpty()) {
 				if (!tree->trees_.contains(name().toString()))
-					tree->trees_[name().toString()] = new VariantTree(tree);
+					tree->addTree(name().toString());
 				readTree(tree->trees_[name().toString()]);
 			}
 			else {
 				QVariant v = readVariant(attributes().value("type").toString());
 				if (v.isValid()) {
-					tree->values_[name().toString()] = v;
+					tree->setLocalValue(name().toString(), v);
 				}
 				else {
 					tree->unknowns2_[name().toString()] = unknown_;
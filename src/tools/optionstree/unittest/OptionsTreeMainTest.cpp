@@ -5,6 +5,8 @@
 #include <QMapIterator>
 #include <QDebug>
 #include <QTime>
+#include <QDir>
+#include <QFile>
 
 #include "qttestutil/qttestutil.h"
 
@@ -40,6 +42,20 @@ private:
 	QList<int> results_;
 };
 
+class OptionsSubscriber : public QObject
+{
+	Q_OBJECT
+public:
+	OptionsSubscriber() : notified(0) {}
+
+	int notified;
+	QList<QStringList> changes;
+
+public slots:
+	void optionsChanged() { ++notified; }
+	void optionsChanged(const QStringList& names) { changes += names; }
+};
+
 class OptionsTreeMainTest : public QObject
 {
 	Q_OBJECT
@@ -104,6 +120,83 @@ private slots:
 		verifyTree(&tree2);
 	}
 
+	void snapshotTest() {
+		QString source = QDir::tempPath() + "/optionstest.xml";
+		QString snapshot = source + ".snapshot";
+
+		OptionsTree tree;
+		initTree(&tree);
+		QVERIFY(tree.saveOptions(source, "OptionsTest", "http://psi-im.org/optionstest", "0.1"));
+		QVERIFY(tree.saveSnapshot(snapshot, source, "0.1"));
+
+		OptionsTree tree2;
+		QVERIFY(tree2.loadSnapshot(snapshot, source, "0.1"));
+		verifyTree(&tree2);
+
+		OptionsTree tree3;
+		QVERIFY(!tree3.loadSnapshot(snapshot, source, "0.2"));
+
+		QFile::remove(source);
+		QFile::remove(snapshot);
+	}
+
+	void mapTest() {
+		OptionsTree tree;
+		QString path = tree.mapPut("verona.houses", QString("capulet"));
+		QCOMPARE(path, QString("verona.houses.m0"));
+		tree.mapPut("verona.houses", QString("montague"), "heir", QString("romeo"));
+		tree.mapPut("verona.houses", QString("capulet"), "heir", QString("juliet"));
+
+		QCOMPARE(tree.mapPut("verona.houses", QString("capulet")), path);
+		QCOMPARE(tree.mapLookup("verona.houses", QString("montague")), QString("verona.houses.m1"));
+		QCOMPARE(tree.mapGet("verona.houses", QString("capulet"), "heir"), QVariant(QString("juliet")));
+		QCOMPARE(tree.mapGet("verona.houses", QString("escalus"), "heir", QString("none")), QVariant(QString("none")));
+		QCOMPARE(tree.mapKeyList("verona.houses").count(), 2);
+
+		// changing and removing keys has to be reflected by lookups
+		tree.setOption("verona.houses.m1.key", QString("montecchi"));
+		QCOMPARE(tree.mapGet("verona.houses", QString("montague"), "heir", QString("none")), QVariant(QString("none")));
+		QCOMPARE(tree.mapGet("verona.houses", QString("montecchi"), "heir"), QVariant(QString("romeo")));
+
+		tree.removeOption("verona.houses.m0", true);
+		QCOMPARE(tree.mapGet("verona.houses", QString("capulet"), "heir", QString("none")), QVariant(QString("none")));
+		QCOMPARE(tree.mapPut("verona.houses", QString("escalus")), QString("verona.houses.m0"));
+		QCOMPARE(tree.mapKeyList("verona.houses").count(), 2);
+	}
+
+	void subscribeTest() {
+		OptionsTree tree;
+		OptionsSubscriber verona, montague, everyone;
+		tree.subscribe("verona", &verona, SLOT(optionsChanged(const QStringList&)));
+		tree.subscribe("verona.montague", &montague, SLOT(optionsChanged()));
+		tree.subscribe("", &everyone, SLOT(optionsChanged(const QStringList&)));
+
+		tree.setOption("verona.montague.romeo", QString("poisoned"));
+		tree.setOption("verona.city", true);
+		tree.setOption("veronamontague", 1);
+		tree.setOption("verona.montague.romeo", QString("dead"));
+		QCOMPARE(verona.changes.count(), 0);
+
+		QCoreApplication::processEvents();
+		QCOMPARE(verona.changes.count(), 1);
+		QCOMPARE(verona.changes.first(), QStringList() << "verona.montague.romeo" << "verona.city");
+		QCOMPARE(montague.notified, 1);
+		QCOMPARE(everyone.changes.count(), 1);
+		QCOMPARE(everyone.changes.first().count(), 3);
+
+		tree.unsubscribe(&verona);
+		{
+			OptionsSubscriber capulet;
+			tree.subscribe("capulet", &capulet, SLOT(optionsChanged()));
+		}
+		tree.setOption("verona.city", false);
+		tree.setOption("capulet.juliet", QString("girly"));
+		QCoreApplication::processEvents();
+		QCOMPARE(verona.changes.count(), 1);
+		QCOMPARE(montague.notified, 1);
+		QCOMPARE(everyone.changes.count(), 2);
+	}
+
 #if 0
 	void stressTest() {
 		bench_.startIteration();
@@ -28,6 +28,7 @@
 #include <QKeySequence>
 #include <QStringList>
 #include <QColor>
+#include <QDataStream>
 #include "xmpp/base64/base64.h"
 
 using namespace XMPP;
@@ -78,6 +79,63 @@ bool VariantTree::getKeyRest(const QString& node, QString &key, QString &rest)
 }
 
 
+/**
+ * Returns the subtree at @a node, or this tree if @a node is empty.
+ * Returns 0 if there is no such subtree.
+ */
+const VariantTree *VariantTree::findTree(const QString &node) const
+{
+	const VariantTree *tree = this;
+	QString path = node, key, rest;
+	while (!path.isEmpty()) {
+		if (getKeyRest(path, key, rest)) {
+			path = rest;
+		}
+		else {
+			key = path;
+			path = QString();
+		}
+		tree = tree->trees_.value(key);
+		if (!tree)
+			return 0;
+	}
+	return tree;
+}
+
+/**
+ * Creates a child tree called @a name
+ */
+VariantTree *VariantTree::addTree(const QString &name)
+{
+	VariantTree *tree = new VariantTree(this);
+	tree->name_ = name;
+	trees_[name] = tree;
+	return tree;
+}
+
+/**
+ * Sets the value @a name of this tier. A "key" value is also recorded in
+ * the parent's map index, which is what makes map lookups cheap.
+ */
+void VariantTree::setLocalValue(const QString &name, const QVariant &value)
+{
+	VariantTree *parentTree = qobject_cast<VariantTree*>(parent());
+	if (parentTree && name == "key") {
+		if (values_.contains(name))
+			parentTree->mapIndex_.remove(values_[name].toString(), name_);
+		parentTree->mapIndex_.insert(value.toString(), name_);
+	}
+	values_[name] = value;
+}
+
+void VariantTree::removeLocalValue(const QString &name)
+{
+	VariantTree *parentTree = qobject_cast<VariantTree*>(parent());
+	if (parentTree && name == "key" && values_.contains(name))
+		parentTree->mapIndex_.remove(values_[name].toString(), name_);
+	values_.remove(name);
+}
+
 bool VariantTree::isValidNodeName(const QString &name)
 {
 /* XML backend:
@@ -119,7 +177,7 @@ void VariantTree::setValue(QString node, QVariant value)
 				return;
 			}
 			//create a new tier
-			trees_[key]=new VariantTree(this);
+			addTree(key);
 		} 
 		//pass it down a level
 		trees_[key]->setValue(subnode,value);
@@ -131,7 +189,7 @@ void VariantTree::setValue(QString node, QVariant value)
 			qWarning("Error: Trying to add option value %s but it already exists as a subtree", qPrintable(node));
 			return;
 		}
-		values_[node]=value;
+		setLocalValue(node, value);
 	}
 }
 
@@ -169,9 +227,11 @@ bool VariantTree::remove(const QString &node, bool internal_nodes)
 		VariantTree *tree;
 		//this tier
 		if (values_.contains(node)) {
-			values_.remove(node);
+			removeLocalValue(node);
 			return true;
 		} else if (internal_nodes && (tree = trees_.take(node))) {
+			if (tree->values_.contains("key"))
+				mapIndex_.remove(tree->values_["key"].toString(), node);
 			delete tree;
 			return true;
 		}
@@ -220,7 +280,7 @@ void VariantTree::setComment(QString node, QString comment)
 				return;
 			}
 			//create a new tier
-			trees_[key]=new VariantTree(this);
+			addTree(key);
 		} 
 		//pass it down a level
 		trees_[key]->setComment(subnode,comment);
@@ -305,6 +365,56 @@ QStringList VariantTree::nodeChildren(const QString& node, bool direct, bool int
 }
 
 
+/**
+ * Finds the child of the map @a node whose "key" value equals @a key.
+ * @return name of the child (relative to @a node) or a null string
+ */
+QString VariantTree::mapLookup(const QString &node, const QVariant &key) const
+{
+	const VariantTree *map = findTree(node);
+	if (!map)
+		return QString();
+
+	QString keyString = key.toString();
+	QMultiHash<QString, QString>::const_iterator it = map->mapIndex_.constFind(keyString);
+	for (; it != map->mapIndex_.constEnd() && it.key() == keyString; ++it) {
+		const VariantTree *child = map->trees_.value(it.value());
+		if (child && child->values_.value("key") == key)
+			return it.value();
+	}
+	return QString();
+}
+
+/**
+ * Returns the "key" values of all children of the map @a node
+ */
+QVariantList VariantTree::mapKeyList(const QString &node) const
+{
+	QVariantList keys;
+	const VariantTree *map = findTree(node);
+	if (map) {
+		foreach(const VariantTree *child, map->trees_) {
+			keys << child->values_.value("key");
+		}
+	}
+	return keys;
+}
+
+/**
+ * Returns the first "m<number>" name not used by a child of the map @a node
+ */
+QString VariantTree::mapFreeChildName(const QString &node) const
+{
+	const VariantTree *map = findTree(node);
+	QString name;
+	int i = 0;
+	do {
+		name = "m" + QString::number(i);
+		++i;
+	} while (map && (map->trees_.contains(name) || map->values_.contains(name)));
+	return name;
+}
+
 /**
  * 
  */
@@ -351,7 +461,7 @@ void VariantTree::fromXml(const QDomElement &ele)
 		if (!child.hasAttribute("type")) {
 			// Subnode
 			if ( !trees_.contains(name) )
-				trees_[name] = new VariantTree(this);
+				addTree(name);
 			trees_[name]->fromXml(child);
 		} 
 		else {
@@ -359,7 +469,7 @@ void VariantTree::fromXml(const QDomElement &ele)
 			QVariant val;
 			val = elementToVariant(child);
 			if (val.isValid()) {
-				values_[name] = val;
+				setLocalValue(name, val);
 			} else {
 				isunknown = true;
 				if (!unknownsDoc) unknownsDoc = new QDomDocument();
@@ -378,6 +488,145 @@ void VariantTree::fromXml(const QDomElement &ele)
 	}
 }
 
+/**
+ * Writes the tree in a compact binary form: a table of all node names
+ * followed by the nodes, which refer to their names by index.
+ * Trees holding values of unknown types can't be written this way.
+ */
+bool VariantTree::toBinary(QDataStream &out) const
+{
+	if (hasUnknowns())
+		return false;
+
+	QHash<QString, quint32> names;
+	collectNames(names);
+	QStringList table;
+	for (int i = 0; i < names.count(); ++i)
+		table << QString();
+	QHashIterator<QString, quint32> it(names);
+	while (it.hasNext()) {
+		it.next();
+		table[it.value()] = it.key();
+	}
+
+	out << table;
+	writeBinary(out, names);
+	return out.status() == QDataStream::Ok;
+}
+
+/**
+ * Reads a tree written by toBinary() into this (empty) tree.
+ */
+bool VariantTree::fromBinary(QDataStream &in)
+{
+	QStringList names;
+	in >> names;
+	return in.status() == QDataStream::Ok && readBinary(in, names);
+}
+
+/**
+ * Copies all nodes, values and comments of @a other into this tree,
+ * the same way fromXml() adds to the existing nodes.
+ */
+void VariantTree::merge(const VariantTree &other)
+{
+	QHashIterator<QString, VariantTree*> trees(other.trees_);
+	while (trees.hasNext()) {
+		trees.next();
+		if (!trees_.contains(trees.key()))
+			addTree(trees.key());
+		trees_[trees.key()]->merge(*trees.value());
+	}
+
+	QHashIterator<QString, QVariant> values(other.values_);
+	while (values.hasNext()) {
+		values.next();
+		setLocalValue(values.key(), values.value());
+	}
+
+	QHashIterator<QString, QString> comments(other.comments_);
+	while (comments.hasNext()) {
+		comments.next();
+		comments_[comments.key()] = comments.value();
+	}
+}
+
+bool VariantTree::hasUnknowns() const
+{
+	if (!unknowns_.isEmpty() || !unknowns2_.isEmpty())
+		return true;
+	foreach(const VariantTree *tree, trees_) {
+		if (tree->hasUnknowns())
+			return true;
+	}
+	return false;
+}
+
+void VariantTree::collectNames(QHash<QString, quint32> &names) const
+{
+	QHashIterator<QString, VariantTree*> trees(trees_);
+	while (trees.hasNext()) {
+		trees.next();
+		if (!names.contains(trees.key()))
+			names.insert(trees.key(), names.count());
+		trees.value()->collectNames(names);
+	}
+	foreach(const QString &name, values_.keys()) {
+		if (!names.contains(name))
+			names.insert(name, names.count());
+	}
+}
+
+void VariantTree::writeBinary(QDataStream &out, const QHash<QString, quint32> &names) const
+{
+	out << quint32(trees_.count());
+	QHashIterator<QString, VariantTree*> trees(trees_);
+	while (trees.hasNext()) {
+		trees.next();
+		out << names.value(trees.key());
+		trees.value()->writeBinary(out, names);
+	}
+
+	out << quint32(values_.count());
+	QHashIterator<QString, QVariant> values(values_);
+	while (values.hasNext()) {
+		values.next();
+		out << names.value(values.key()) << values.value();
+	}
+
+	// comments are rare, so their names are not interned
+	out << comments_;
+}
+
+bool VariantTree::readBinary(QDataStream &in, const QStringList &names)
+{
+	quint32 count, name;
+
+	in >> count;
+	for (quint32 i = 0; i < count && in.status() == QDataStream::Ok; ++i) {
+		in >> name;
+		if (name >= quint32(names.count()))
+			return false;
+		VariantTree *tree = trees_.value(names[name]);
+		if (!tree)
+			tree = addTree(names[name]);
+		if (!tree->readBinary(in, names))
+			return false;
+	}
+
+	in >> count;
+	for (quint32 i = 0; i < count && in.status() == QDataStream::Ok; ++i) {
+		QVariant value;
+		in >> name >> value;
+		if (name >= quint32(names.count()) || !value.isValid())
+			return false;
+		setLocalValue(names[name], value);
+	}
+
+	in >> comments_;
+	return in.status() == QDataStream::Ok;
+}
+
 /**
  * Extracts a variant from an element. 
  * The attribute of the element is used to determine the type.
@@ -28,6 +28,7 @@
 class QDomDocument;
 class QDomElement;
 class QDomDocumentFragment;
+class QDataStream;
 
 
 /**
@@ -66,9 +67,17 @@ public:
 	
 	QStringList nodeChildren(const QString& node = "", bool direct = false, bool internal_nodes = false) const; 
 
+	QString mapLookup(const QString &node, const QVariant &key) const;
+	QVariantList mapKeyList(const QString &node) const;
+	QString mapFreeChildName(const QString &node) const;
+
 	void toXml(QDomDocument &doc, QDomElement& ele) const;
 	void fromXml(const QDomElement &ele);
 
+	bool toBinary(QDataStream &out) const;
+	bool fromBinary(QDataStream &in);
+	void merge(const VariantTree &other);
+
 	static bool isValidNodeName(const QString &name);
 	
 	static const QVariant missingValue;
@@ -81,11 +90,22 @@ protected:
 	static bool getKeyRest(const QString& node, QString &key, QString &rest);
 
 private:
+	const VariantTree *findTree(const QString &node) const;
+	VariantTree *addTree(const QString &name);
+	void setLocalValue(const QString &name, const QVariant &value);
+	void removeLocalValue(const QString &name);
+	bool hasUnknowns() const;
+	void collectNames(QHash<QString, quint32> &names) const;
+	void writeBinary(QDataStream &out, const QHash<QString, quint32> &names) const;
+	bool readBinary(QDataStream &in, const QStringList &names);
+
+	QString name_;
 	QHash<QString, VariantTree*> trees_;
 	QHash<QString, QVariant> values_;
 	QHash<QString, QString> comments_;
 	QHash<QString, QDomDocumentFragment> unknowns_;		// unknown types preservation
 	QHash<QString, QString> unknowns2_;		// unknown types preservation
+	QMultiHash<QString, QString> mapIndex_;	// "key" value of a child tree -> its name
 	
 	// needed to have a document for the fragments.
 	static QDomDocument *unknownsDoc;
@@ -0,0 +1,90 @@
+#include <QtTest/QtTest>
+#include <QApplication>
+#include <QStringList>
+
+#include "msgmle.h"
+
+// Replays a groupchat history burst like the one a busy room sends on
+// join, formatted the way GCMainDlg::appendMessage() does, into a
+// ChatView: once paragraph by paragraph and once through the render
+// queue.
+class BenchChatView: public QObject
+{
+	Q_OBJECT
+private:
+	enum { BURSTSIZE = 500 };
+	QStringList burst;
+
+	ChatView *createView()
+	{
+		ChatView *view = new ChatView(0);
+		view->resize(500, 400);
+		view->show();
+		QTest::qWaitForWindowShown(view);
+		return view;
+	}
+
+private slots:
+	void initTestCase()
+	{
+		static const char *nicks[] = { "alice", "bob", "carol", "dave", "eve" };
+		static const char *colors[] = { "#0000A0", "#A00000", "#00A000", "#A0A000", "#A000A0" };
+
+		for (int i = 0; i < BURSTSIZE; ++i) {
+			QString timestr = QString().sprintf("%02d:%02d:%02d", (i / 3600) % 24, (i / 60) % 60, i % 60);
+			burst += QString("<font color=\"%1\">").arg(colors[i % 5]) + QString("[%1] &lt;").arg(timestr) +
+			         nicks[i % 5] + QString("&gt;</font> ") + "<font color=\"#000000\">" +
+			         QString("message number %1, long enough to wrap once or twice in a narrow window "
+			                 "and with a <a href=\"http://psi-im.org/\">link</a> in it").arg(i) + "</font>";
+		}
+	}
+
+	void testQueuedOrder()
+	{
+		ChatView *view = createView();
+		view->queueText("one");
+		view->queueText("two");
+		view->appendText("three");
+		view->queueText("four");
+		view->flushQueuedText();
+		QCOMPARE(view->getPlainText().split('\n', QString::SkipEmptyParts),
+		         QStringList() << "one" << "two" << "three" << "four");
+		delete view;
+	}
+
+	void testQueuedFollowsBottom()
+	{
+		ChatView *view = createView();
+		foreach(const QString &text, burst)
+			view->queueText(text);
+		view->flushQueuedText();
+		QVERIFY(view->atBottom());
+		delete view;
+	}
+
+	void benchmarkAppend()
+	{
+		QBENCHMARK {
+			ChatView *view = createView();
+			foreach(const QString &text, burst)
+				view->appendText(text);
+			qApp->processEvents();
+			delete view;
+		}
+	}
+
+	void benchmarkQueued()
+	{
+		QBENCHMARK {
+			ChatView *view = createView();
+			foreach(const QString &text, burst)
+				view->queueText(text);
+			view->flushQueuedText();
+			qApp->processEvents();
+			delete view;
+		}
+	}
+};
+
+QTEST_MAIN(BenchChatView)
+#include "benchchatview.moc"
@@ -0,0 +1,4 @@
+TARGET = benchchatview
+SOURCES += benchchatview.cpp
+
+include(../half_of_psi.pri)
@@ -0,0 +1,367 @@
+#include <QtTest/QtTest>
+#include <QApplication>
+#include <QDir>
+#include <QFile>
+#include <QHash>
+#include <stdio.h>
+#ifdef Q_OS_UNIX
+#include <sys/resource.h>
+#endif
+
+#include "psicon.h"
+#include "psiaccount.h"
+#include "psicontactlist.h"
+#include "psicontactlistmodel.h"
+#include "contactlistmodelupdater.h"
+#include "contactlistproxymodel.h"
+#include "psicontactlistview.h"
+#include "profiles.h"
+#include "psioptions.h"
+#include "applicationinfo.h"
+#include "optionstree.h"
+#include "xmpp_roster.h"
+#include "xmpp_message.h"
+#include "xmpp_resource.h"
+#include "xmpp_status.h"
+
+using namespace XMPP;
+
+// Counts the signals the view would have to react to.
+class ModelSignalCounter : public QObject
+{
+	Q_OBJECT
+public:
+	ModelSignalCounter(QAbstractItemModel* model, const QString& prefix)
+		: QObject(model)
+		, prefix_(prefix)
+	{
+		connect(model, SIGNAL(dataChanged(const QModelIndex&, const QModelIndex&)), SLOT(dataChanged()));
+		connect(model, SIGNAL(rowsInserted(const QModelIndex&, int, int)), SLOT(rowsInserted()));
+		connect(model, SIGNAL(rowsRemoved(const QModelIndex&, int, int)), SLOT(rowsRemoved()));
+		connect(model, SIGNAL(layoutChanged()), SLOT(layoutChanged()));
+		connect(model, SIGNAL(modelReset()), SLOT(modelReset()));
+		reset();
+	}
+
+	void reset()
+	{
+		counts_.clear();
+		counts_["dataChanged"] = 0;
+		counts_["rowsInserted"] = 0;
+		counts_["rowsRemoved"] = 0;
+		counts_["layoutChanged"] = 0;
+		counts_["modelReset"] = 0;
+	}
+
+	QString toString() const
+	{
+		QStringList result;
+		foreach(QString name, QStringList(counts_.keys())) {
+			result << QString("%1.%2=%3").arg(prefix_, name).arg(counts_[name]);
+		}
+		result.sort();
+		return result.join("\t");
+	}
+
+private slots:
+	void dataChanged()   { ++counts_["dataChanged"]; }
+	void rowsInserted()  { ++counts_["rowsInserted"]; }
+	void rowsRemoved()   { ++counts_["rowsRemoved"]; }
+	void layoutChanged() { ++counts_["layoutChanged"]; }
+	void modelReset()    { ++counts_["modelReset"]; }
+
+private:
+	QString prefix_;
+	QHash<QString, int> counts_;
+};
+
+/**
+ * Replays roster, presence and message traffic against a set of accounts
+ * that never connect, and prints one RESULT line per stage:
+ *
+ *   RESULT <tab> stage=roster-load <tab> msecs=... <tab> model.dataChanged=... ... <tab> updater.commits=... ... <tab> peak_rss_kb=...
+ *
+ * The roster size is taken from BENCH_ACCOUNTS, BENCH_CONTACTS (per
+ * account), BENCH_GROUPS and BENCH_MESSAGES environment variables.
+ * The stages depend on each other and must run in declaration order.
+ */
+class BenchContactList : public QObject
+{
+	Q_OBJECT
+private:
+	QString dataDir_;
+	PsiCon* psi_;
+	PsiContactListModel* model_;
+	ContactListProxyModel* proxy_;
+	PsiContactListView* view_;
+	ModelSignalCounter* modelSignals_;
+	ModelSignalCounter* proxySignals_;
+	ContactListModelUpdater* updater_;
+	QList<PsiAccount*> accounts_;
+	QList<QList<RosterItem> > rosters_;
+	int accountCount_;
+	int contactCount_;
+	int groupCount_;
+	int messageCount_;
+	QTime stageTime_;
+
+	static int envInt(const char* name, int defaultValue)
+	{
+		bool ok = false;
+		int result = QString::fromLocal8Bit(qgetenv(name)).toInt(&ok);
+		return ok && result > 0 ? result : defaultValue;
+	}
+
+	static long peakMemoryKiB()
+	{
+#ifdef Q_OS_LINUX
+		QFile status("/proc/self/status");
+		if (status.open(QIODevice::ReadOnly | QIODevice::Text)) {
+			foreach(QByteArray line, status.readAll().split('\n')) {
+				if (line.startsWith("VmHWM:"))
+					return line.mid(6).trimmed().split(' ').first().toLong();
+			}
+		}
+#endif
+#ifdef Q_OS_UNIX
+		struct rusage usage;
+		if (!getrusage(RUSAGE_SELF, &usage)) {
+#ifdef Q_OS_MAC
+			return usage.ru_maxrss / 1024;
+#else
+			return usage.ru_maxrss;
+#endif
+		}
+#endif
+		return -1;
+	}
+
+	static void removeDir(const QString& path)
+	{
+		QDir dir(path);
+		foreach(QFileInfo fi, dir.entryInfoList(QDir::AllEntries | QDir::Hidden | QDir::NoDotAndDotDot)) {
+			if (fi.isDir() && !fi.isSymLink())
+				removeDir(fi.absoluteFilePath());
+			else
+				dir.remove(fi.fileName());
+		}
+		dir.rmdir(path);
+	}
+
+	static Jid contactJid(int account, int contact)
+	{
+		return Jid(QString("contact%1.%2@example.com").arg(account).arg(contact));
+	}
+
+	void invoke(PsiAccount* account, const char* slot, QGenericArgument a0, QGenericArgument a1 = QGenericArgument(), QGenericArgument a2 = QGenericArgument())
+	{
+		bool ok = QMetaObject::invokeMethod(account, slot, Qt::DirectConnection, a0, a1, a2);
+		QVERIFY(ok);
+	}
+
+	void beginStage()
+	{
+		modelSignals_->reset();
+		proxySignals_->reset();
+		updater_->resetStats();
+		stageTime_.start();
+	}
+
+	// Flushes the pending model updates, repaints the roster and prints
+	// the stage result.
+	void endStage(const QString& stage)
+	{
+		model_->updaterCommit();
+		qApp->processEvents();
+		view_->viewport()->repaint();
+
+		const ContactListModelUpdater::Stats& stats = updater_->stats();
+		const PsiContactList* contactList = psi_->contactList();
+		printf("RESULT\tstage=%s\tmsecs=%d\t%s\t%s\t"
+		       "updater.commits=%d\tupdater.resets=%d\tupdater.maxQueueDepth=%d\t"
+		       "updater.maxCommitMsecs=%d\tupdater.maxLatencyMsecs=%d\t"
+		       "contacts.online=%d\tcontacts.alerting=%d\tevents.queued=%d\tpeak_rss_kb=%ld\n",
+		       qPrintable(stage),
+		       stageTime_.elapsed(),
+		       qPrintable(modelSignals_->toString()),
+		       qPrintable(proxySignals_->toString()),
+		       stats.commits, stats.resets, stats.maxQueueDepth,
+		       stats.maxCommitMsecs, stats.maxLatencyMsecs,
+		       contactList->onlineContactsCount(), contactList->alertingContactsCount(),
+		       contactList->queueCount(),
+		       peakMemoryKiB());
+		fflush(stdout);
+	}
+
+	void writeAccounts()
+	{
+		OptionsTree tree;
+		for (int i = 0; i < accountCount_; ++i) {
+			UserAccount acc;
+			acc.name = QString("bench%1").arg(i);
+			acc.jid = QString("bench%1@example.com").arg(i);
+			acc.opt_enabled = true;
+			acc.opt_auto = false;
+			acc.toOptions(&tree, QString("accounts.a%1").arg(i));
+		}
+		QString file = pathToProfile(activeProfile, ApplicationInfo::ConfigLocation) + "/accounts.xml";
+		QVERIFY(tree.saveOptions(file, "accounts", ApplicationInfo::optionsNS(), ApplicationInfo::version()));
+	}
+
+private slots:
+	void initTestCase()
+	{
+		accountCount_ = envInt("BENCH_ACCOUNTS", 2);
+		contactCount_ = envInt("BENCH_CONTACTS", 2000);
+		groupCount_   = envInt("BENCH_GROUPS", 40);
+		messageCount_ = envInt("BENCH_MESSAGES", 500);
+
+		// keep the user's profile out of it
+		dataDir_ = QDir::tempPath() + QString("/psi-benchcontactlist-%1").arg(QCoreApplication::applicationPid());
+		QVERIFY(QDir().mkpath(dataDir_));
+		qputenv("PSIDATADIR", QFile::encodeName(dataDir_));
+		activeProfile = "default";
+		QVERIFY(profileNew(activeProfile));
+		writeAccounts();
+
+		// nothing but the roster should react to the traffic
+		PsiOptions* o = PsiOptions::instance();
+		o->setOption("options.ui.tip.show", false);
+		o->setOption("options.ui.notifications.sounds.enable", false);
+		o->setOption("options.ui.notifications.passive-popups.enabled", false);
+
+		psi_ = new PsiCon();
+		QVERIFY(psi_->init());
+		psi_->contactList()->setShowOffline(true);
+		accounts_ = psi_->contactList()->accounts();
+		QCOMPARE(accounts_.count(), accountCount_);
+
+		model_ = new PsiContactListModel(psi_->contactList());
+		model_->invalidateLayout();
+		model_->setGroupsEnabled(true);
+		model_->setAccountsEnabled(true);
+		proxy_ = new ContactListProxyModel(model_);
+		proxy_->setSourceModel(model_);
+		modelSignals_ = new ModelSignalCounter(model_, "model");
+		proxySignals_ = new ModelSignalCounter(proxy_, "proxy");
+		updater_ = model_->findChild<ContactListModelUpdater*>();
+		QVERIFY(updater_);
+
+		view_ = new PsiContactListView(0);
+		view_->setModel(proxy_);
+		view_->resize(250, 600);
+		view_->show();
+		QTest::qWaitForWindowShown(view_);
+
+		printf("CONFIG\taccounts=%d\tcontacts=%d\tgroups=%d\tmessages=%d\n",
+		       accountCount_, contactCount_, groupCount_, messageCount_);
+	}
+
+	void cleanupTestCase()
+	{
+		delete view_;
+		delete model_;
+		psi_->deinit();
+		delete psi_;
+		removeDir(dataDir_);
+	}
+
+	void rosterLoad()
+	{
+		beginStage();
+		for (int a = 0; a < accounts_.count(); ++a) {
+			QList<RosterItem> roster;
+			for (int c = 0; c < contactCount_; ++c) {
+				RosterItem item(contactJid(a, c));
+				item.setName(QString("Contact %1 of account %2").arg(c).arg(a));
+				item.setGroups(QStringList(QString("Group %1").arg(c % groupCount_)));
+				item.setSubscription(Subscription(Subscription::Both));
+				invoke(accounts_[a], "client_rosterItemUpdated", Q_ARG(RosterItem, item));
+				roster << item;
+			}
+			rosters_ << roster;
+			invoke(accounts_[a], "client_rosterRequestFinished", Q_ARG(bool, true), Q_ARG(int, 0), Q_ARG(QString, QString()));
+		}
+		endStage("roster-load");
+	}
+
+	void presenceStorm()
+	{
+		static const Status::Type types[] = {
+			Status::Online, Status::Away, Status::XA, Status::DND, Status::FFC
+		};
+
+		beginStage();
+		for (int a = 0; a < accounts_.count(); ++a) {
+			for (int c = 0; c < contactCount_; ++c) {
+				Resource r("psi", Status(types[c % 5], QString("status of contact %1").arg(c), 5));
+				invoke(accounts_[a], "client_resourceAvailable", Q_ARG(Jid, contactJid(a, c)), Q_ARG(Resource, r));
+			}
+		}
+		endStage("presence-online");
+
+		beginStage();
+		for (int a = 0; a < accounts_.count(); ++a) {
+			for (int c = 0; c < contactCount_; c += 2) {
+				Resource r("psi", Status(types[(c + 1) % 5], QString("new status of contact %1").arg(c), 5));
+				invoke(accounts_[a], "client_resourceAvailable", Q_ARG(Jid, contactJid(a, c)), Q_ARG(Resource, r));
+			}
+		}
+		endStage("presence-change");
+
+		beginStage();
+		for (int a = 0; a < accounts_.count(); ++a) {
+			for (int c = 0; c < contactCount_; c += 3) {
+				Resource r("psi", Status(Status::Offline));
+				invoke(accounts_[a], "client_resourceUnavailable", Q_ARG(Jid, contactJid(a, c)), Q_ARG(Resource, r));
+			}
+		}
+		endStage("presence-offline");
+	}
+
+	void rosterPush()
+	{
+		beginStage();
+		for (int a = 0; a < accounts_.count(); ++a) {
+			QList<RosterItem>& roster = rosters_[a];
+			for (int c = 0; c < roster.count(); c += 5) {
+				RosterItem& item = roster[c];
+				item.setName(item.name() + " (renamed)");
+				item.setGroups(QStringList(QString("Group %1").arg((c + 1) % groupCount_)));
+				item.setIsPush(true);
+				invoke(accounts_[a], "client_rosterItemUpdated", Q_ARG(RosterItem, item));
+			}
+		}
+		endStage("roster-push-update");
+
+		beginStage();
+		for (int a = 0; a < accounts_.count(); ++a) {
+			QList<RosterItem>& roster = rosters_[a];
+			for (int c = roster.count() - 1; c >= 0; c -= 20) {
+				RosterItem item = roster.takeAt(c);
+				item.setIsPush(true);
+				invoke(accounts_[a], "client_rosterItemRemoved", Q_ARG(RosterItem, item));
+			}
+		}
+		endStage("roster-push-remove");
+	}
+
+	void messageStorm()
+	{
+		beginStage();
+		for (int i = 0; i < messageCount_; ++i) {
+			int a = i % accounts_.count();
+			const QList<RosterItem>& roster = rosters_[a];
+			Message m(accounts_[a]->jid());
+			m.setFrom(roster[(i * 7) % roster.count()].jid().withResource("psi"));
+			m.setType("chat");
+			m.setBody(QString("message number %1").arg(i));
+			m.setTimeStamp(QDateTime::currentDateTime());
+			invoke(accounts_[a], "client_messageReceived", Q_ARG(Message, m));
+		}
+		endStage("message-storm");
+	}
+};
+
+QTEST_MAIN(BenchContactList)
+#include "benchcontactlist.moc"
@@ -0,0 +1,7 @@
+TARGET = benchcontactlist
+SOURCES += benchcontactlist.cpp
+
+include(../half_of_psi.pri)
+
+# default options
+RESOURCES += $$PSI_CPP/../psi.qrc
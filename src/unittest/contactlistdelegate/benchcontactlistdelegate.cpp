@@ -0,0 +1,137 @@
+#include <QtTest/QtTest>
+#include <QApplication>
+#include <QAbstractListModel>
+#include <QScrollBar>
+
+#include "contactlistview.h"
+#include "contactlistmodel.h"
+#include "contactlistrowsnapshot.h"
+#include "psicontactlistviewdelegate.h"
+#include "psiiconset.h"
+#include "psioptions.h"
+
+// Flat roster with the roles PsiContactListViewDelegate paints contacts
+// from, so the delegate can be measured without accounts and a server.
+class SyntheticRoster : public QAbstractListModel
+{
+public:
+	SyntheticRoster(int count)
+		: count_(count)
+		, revision_(0)
+	{
+		bumpRevisions();
+	}
+
+	// Pretends every contact has changed since the last paint.
+	void bumpRevisions()
+	{
+		firstRevision_ = revision_ + 1;
+		revision_ += count_;
+	}
+
+	int rowCount(const QModelIndex& parent) const
+	{
+		return parent.isValid() ? 0 : count_;
+	}
+
+	QVariant data(const QModelIndex& index, int role) const
+	{
+		int i = index.row();
+		if (role == ContactListModel::TypeRole)
+			return QVariant(ContactListModel::ContactType);
+		if (role == Qt::DisplayRole)
+			return QVariant(name(i));
+		if (role == ContactListModel::RowSnapshotRole) {
+			ContactListRowSnapshot snapshot;
+			snapshot.revision = firstRevision_ + i;
+			snapshot.name = name(i);
+			snapshot.jid = QString("contact%1@example.com").arg(i);
+			if (i % 3)
+				snapshot.statusText = QString("status message of contact number %1, long enough to need eliding").arg(i);
+			snapshot.statusType = statusType(i);
+			snapshot.iconStatus = snapshot.statusType;
+			return qVariantFromValue(snapshot);
+		}
+		return QVariant();
+	}
+
+private:
+	int count_;
+	uint revision_;
+	uint firstRevision_;
+
+	static QString name(int i)
+	{
+		return QString("Contact %1 with a reasonably long nickname").arg(i);
+	}
+
+	static XMPP::Status::Type statusType(int i)
+	{
+		static const XMPP::Status::Type types[] = {
+			XMPP::Status::Online, XMPP::Status::Away, XMPP::Status::XA,
+			XMPP::Status::DND, XMPP::Status::Offline
+		};
+		return types[i % 5];
+	}
+};
+
+class BenchContactListDelegate : public QObject
+{
+	Q_OBJECT
+private:
+	enum { ROSTERSIZE = 5000 };
+	SyntheticRoster* roster;
+	ContactListView* view;
+
+	// Scrolls from the top to the bottom of the roster a page at a time,
+	// repainting the viewport after every step.
+	void scrollThrough()
+	{
+		QScrollBar* bar = view->verticalScrollBar();
+		bar->setValue(0);
+		while (bar->value() < bar->maximum()) {
+			bar->setValue(bar->value() + bar->pageStep());
+			view->viewport()->repaint();
+		}
+	}
+
+private slots:
+	void initTestCase()
+	{
+		PsiOptions::instance();
+		PsiIconset::instance()->loadAll();
+
+		roster = new SyntheticRoster(ROSTERSIZE);
+		view = new ContactListView(0);
+		view->setItemDelegate(new PsiContactListViewDelegate(view));
+		view->setModel(roster);
+		view->resize(250, 600);
+		view->show();
+		QTest::qWaitForWindowShown(view);
+	}
+
+	void cleanupTestCase()
+	{
+		delete view;
+		delete roster;
+	}
+
+	void benchmarkScrollCached()
+	{
+		scrollThrough();
+		QBENCHMARK {
+			scrollThrough();
+		}
+	}
+
+	void benchmarkScrollChanged()
+	{
+		QBENCHMARK {
+			roster->bumpRevisions();
+			scrollThrough();
+		}
+	}
+};
+
+QTEST_MAIN(BenchContactListDelegate)
+#include "benchcontactlistdelegate.moc"
@@ -0,0 +1,70 @@
+#include <QtTest/QtTest>
+
+#include "edbpage.h"
+
+class TestEDBPage : public QObject
+{
+	Q_OBJECT
+private:
+	static QList<int> ids(const EDBPage &page)
+	{
+		QList<int> list;
+		for (int n = 0; n < page.count(); ++n)
+			list += page.id(n);
+		return list;
+	}
+
+private slots:
+	void testBackward()
+	{
+		EDBPage page(9, true, 4, 10);
+		QCOMPARE(ids(page), QList<int>() << 9 << 8 << 7 << 6);
+		QCOMPARE(page.nextId(), QString("5"));
+
+		// clipped at the start of the log
+		EDBPage last(2, true, 4, 10);
+		QCOMPARE(ids(last), QList<int>() << 2 << 1 << 0);
+		QVERIFY(last.nextId().isEmpty());
+	}
+
+	void testForward()
+	{
+		EDBPage page(0, false, 4, 10);
+		QCOMPARE(ids(page), QList<int>() << 0 << 1 << 2 << 3);
+		QCOMPARE(page.nextId(), QString("4"));
+
+		EDBPage last(7, false, 4, 10);
+		QCOMPARE(ids(last), QList<int>() << 7 << 8 << 9);
+		QVERIFY(last.nextId().isEmpty());
+	}
+
+	void testEmptyLog()
+	{
+		EDBPage page(-1, true, 4, 0);
+		QCOMPARE(page.count(), 0);
+		QVERIFY(page.nextId().isEmpty());
+	}
+
+	void testUnreadableEvents()
+	{
+		// the oldest two events of the page can't be parsed, so the last
+		// readable one is 8; paging from its prevId would read 7 and 6 again
+		QSet<int> unreadable;
+		unreadable << 7 << 6;
+		EDBPage page(9, true, 4, 10);
+		int lastRead = -1;
+		foreach (int id, ids(page)) {
+			if (!unreadable.contains(id))
+				lastRead = id;
+		}
+		QCOMPARE(lastRead, 8);
+		QCOMPARE(page.nextId(), QString("5"));
+
+		// a page nothing of which could be read still moves on
+		EDBPage next(6, true, 2, 10);
+		QCOMPARE(next.nextId(), QString("4"));
+	}
+};
+
+QTEST_MAIN(TestEDBPage)
+#include "testedbpage.moc"
@@ -0,0 +1,10 @@
+TARGET = testedbpage
+CONFIG += qtestlib console
+CONFIG -= app_bundle
+QT -= gui
+
+INCLUDEPATH += ../..
+HEADERS += ../../edbpage.h
+SOURCES += \
+	../../edbpage.cpp \
+	testedbpage.cpp
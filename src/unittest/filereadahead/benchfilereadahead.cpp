@@ -0,0 +1,198 @@
+#include <QtTest/QtTest>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QTemporaryFile>
+#include <QEventLoop>
+
+#include "filereadahead.h"
+
+// Sends a file over a loopback TCP connection the way
+// FileTransferHandler feeds a bytestream: never more than SENDBUFSIZE
+// bytes pending in the socket, refilled on bytesWritten(). Either reads
+// the file on the spot (the old way) or takes chunks from a
+// FileReadAhead.
+class LoopbackSender : public QObject
+{
+	Q_OBJECT
+public:
+	enum { SENDBUFSIZE = 65536 };
+
+	LoopbackSender(const QString &fileName, qlonglong size, bool readAhead)
+		: fileName_(fileName), size_(size), readAhead_(readAhead), received_(0), queued_(0)
+		, hash_(QCryptographicHash::Sha1), in_(0), reader_(0)
+	{
+		server_.listen(QHostAddress::LocalHost);
+		connect(&server_, SIGNAL(newConnection()), SLOT(newConnection()));
+		connect(&out_, SIGNAL(connected()), SLOT(connected()));
+		connect(&out_, SIGNAL(bytesWritten(qint64)), SLOT(bytesWritten()));
+	}
+
+	bool run()
+	{
+		out_.connectToHost(QHostAddress::LocalHost, server_.serverPort());
+		QTimer::singleShot(60000, &loop_, SLOT(quit()));
+		loop_.exec();
+		delete reader_;
+		return received_ == size_;
+	}
+
+	QByteArray receivedHash() const
+	{
+		return hash_.result();
+	}
+
+private slots:
+	void newConnection()
+	{
+		in_ = server_.nextPendingConnection();
+		connect(in_, SIGNAL(readyRead()), SLOT(readyRead()));
+	}
+
+	void connected()
+	{
+		if (readAhead_) {
+			reader_ = new FileReadAhead;
+			reader_->open(fileName_, 0, size_);
+			connect(reader_, SIGNAL(readyRead()), SLOT(send()));
+			reader_->start();
+		}
+		else {
+			file_.setFileName(fileName_);
+			file_.open(QIODevice::ReadOnly);
+			send();
+		}
+	}
+
+	void bytesWritten()
+	{
+		QTimer::singleShot(0, this, SLOT(send()));
+	}
+
+	void send()
+	{
+		int needed = SENDBUFSIZE - (int)out_.bytesToWrite();
+		if (!readAhead_) {
+			needed = (int)qMin((qlonglong)needed, size_ - queued_);
+			if (needed <= 0)
+				return;
+			QByteArray a(needed, 0);
+			int r = file_.read(a.data(), a.size());
+			a.resize(r);
+			queued_ += r;
+			out_.write(a);
+			return;
+		}
+
+		while (reader_->hasChunk()) {
+			int size = reader_->nextChunkSize();
+			if (size > needed && out_.bytesToWrite())
+				break;
+			needed -= size;
+			out_.write(reader_->takeChunk());
+		}
+	}
+
+	void readyRead()
+	{
+		QByteArray a = in_->readAll();
+		hash_.addData(a);
+		received_ += a.size();
+		if (received_ == size_)
+			loop_.quit();
+	}
+
+private:
+	QString fileName_;
+	qlonglong size_;
+	bool readAhead_;
+	qlonglong received_, queued_;
+	QCryptographicHash hash_;
+
+	QTcpServer server_;
+	QTcpSocket out_;
+	QTcpSocket *in_;
+	QFile file_;
+	FileReadAhead *reader_;
+	QEventLoop loop_;
+};
+
+class BenchFileReadAhead : public QObject
+{
+	Q_OBJECT
+private:
+	enum { FILESIZE = 64 * 1024 * 1024 };
+	QTemporaryFile file;
+	QByteArray fileHash;
+
+private slots:
+	void initTestCase()
+	{
+		QVERIFY(file.open());
+		QCryptographicHash hash(QCryptographicHash::Sha1);
+		QByteArray block(1024 * 1024, 0);
+		qsrand(1);
+		for (int n = 0; n < FILESIZE / block.size(); ++n) {
+			for (int i = 0; i < block.size(); ++i)
+				block[i] = (char)qrand();
+			hash.addData(block);
+			QCOMPARE(file.write(block), (qint64)block.size());
+		}
+		file.flush();
+		fileHash = hash.result();
+	}
+
+	void testChunks()
+	{
+		// reading from an offset, with a ring smaller than the data
+		qlonglong offset = 12345, length = 1000000;
+		FileReadAhead reader;
+		QVERIFY(reader.open(file.fileName(), offset, length, 4096, 3));
+		reader.start();
+
+		QFile f(file.fileName());
+		QVERIFY(f.open(QIODevice::ReadOnly));
+		QVERIFY(f.seek(offset));
+		QByteArray expected = f.read(length);
+
+		QByteArray data;
+		while (!reader.atEnd()) {
+			if (!reader.hasChunk()) {
+				QTest::qWait(1);
+				continue;
+			}
+			QByteArray chunk = reader.takeChunk();
+			QVERIFY(chunk.size() <= 4096);
+			data += chunk;
+		}
+		QCOMPARE(data.size(), expected.size());
+		QVERIFY(data == expected);
+	}
+
+	void testMissingFile()
+	{
+		FileReadAhead reader;
+		QVERIFY(!reader.open(file.fileName() + ".missing", 0, 1));
+		QVERIFY(!reader.errorString().isEmpty());
+	}
+
+	void benchmarkSynchronousRead()
+	{
+		QBENCHMARK {
+			LoopbackSender sender(file.fileName(), FILESIZE, false);
+			QVERIFY(sender.run());
+			QVERIFY(sender.receivedHash() == fileHash);
+		}
+	}
+
+	void benchmarkReadAhead()
+	{
+		QBENCHMARK {
+			LoopbackSender sender(file.fileName(), FILESIZE, true);
+			QVERIFY(sender.run());
+			QVERIFY(sender.receivedHash() == fileHash);
+		}
+	}
+};
+
+QTEST_MAIN(BenchFileReadAhead)
+#include "benchfilereadahead.moc"
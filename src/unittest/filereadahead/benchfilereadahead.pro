@@ -0,0 +1,11 @@
+TARGET = benchfilereadahead
+CONFIG += qtestlib console
+CONFIG -= app_bundle
+QT -= gui
+QT += network
+
+INCLUDEPATH += ../..
+HEADERS += ../../filereadahead.h
+SOURCES += \
+	../../filereadahead.cpp \
+	benchfilereadahead.cpp
@@ -0,0 +1,97 @@
+#include <QtTest/QtTest>
+#include <QTemporaryFile>
+
+#include "filewritebehind.h"
+
+class TestFileWriteBehind : public QObject
+{
+	Q_OBJECT
+private:
+	static QByteArray pattern(int size, int seed)
+	{
+		QByteArray a(size, 0);
+		for (int i = 0; i < size; ++i)
+			a[i] = (char)(seed + i * 7);
+		return a;
+	}
+
+private slots:
+	void testWrite()
+	{
+		QTemporaryFile tmp;
+		QVERIFY(tmp.open());
+		tmp.close();
+
+		// packets of odd sizes, adding up to a few write blocks
+		FileWriteBehind writer;
+		QVERIFY(writer.open(tmp.fileName(), 0, 3 * 1024 * 1024));
+		QByteArray expected;
+		for (int n = 0; expected.size() < 3 * FileWriteBehind::WriteSize; ++n) {
+			QByteArray packet = pattern(1000 + n % 4000, n);
+			writer.write(packet);
+			expected += packet;
+		}
+		QVERIFY(writer.close());
+
+		QFile f(tmp.fileName());
+		QVERIFY(f.open(QIODevice::ReadOnly));
+		// the reservation doesn't show in the size
+		QCOMPARE(f.size(), (qint64)expected.size());
+		QVERIFY(f.readAll() == expected);
+	}
+
+	void testResume()
+	{
+		QTemporaryFile tmp;
+		QVERIFY(tmp.open());
+		QByteArray head = pattern(12345, 1);
+		tmp.write(head);
+		tmp.close();
+
+		FileWriteBehind writer;
+		QVERIFY(writer.open(tmp.fileName(), head.size()));
+		QByteArray tail = pattern(FileWriteBehind::WriteSize + 100, 2);
+		writer.write(tail);
+		QVERIFY(writer.close());
+
+		QFile f(tmp.fileName());
+		QVERIFY(f.open(QIODevice::ReadOnly));
+		QVERIFY(f.readAll() == head + tail);
+	}
+
+	void testFinish()
+	{
+		QTemporaryFile tmp;
+		QVERIFY(tmp.open());
+		tmp.close();
+
+		FileWriteBehind writer;
+		QSignalSpy finished(&writer, SIGNAL(finished()));
+		QVERIFY(writer.open(tmp.fileName(), 0));
+		QByteArray data = pattern(FileWriteBehind::WriteSize / 2, 3);
+		writer.write(data);
+
+		// finish() doesn't wait, the worker stops once it's all written
+		writer.finish();
+		QVERIFY(writer.wait(10000));
+		QCOMPARE(finished.count(), 1);
+
+		// dropped, the writer is finishing
+		writer.write(data);
+		QVERIFY(writer.close());
+
+		QFile f(tmp.fileName());
+		QVERIFY(f.open(QIODevice::ReadOnly));
+		QVERIFY(f.readAll() == data);
+	}
+
+	void testOpenFailure()
+	{
+		FileWriteBehind writer;
+		QVERIFY(!writer.open("/nonexistent/directory/file", 0));
+		QVERIFY(!writer.errorString().isEmpty());
+	}
+};
+
+QTEST_MAIN(TestFileWriteBehind)
+#include "testfilewritebehind.moc"
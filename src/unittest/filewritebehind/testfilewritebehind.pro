@@ -0,0 +1,10 @@
+TARGET = testfilewritebehind
+CONFIG += qtestlib console
+CONFIG -= app_bundle
+QT -= gui
+
+INCLUDEPATH += ../..
+HEADERS += ../../filewritebehind.h
+SOURCES += \
+	../../filewritebehind.cpp \
+	testfilewritebehind.cpp
@@ -0,0 +1,83 @@
+#include <QtTest/QtTest>
+#include <QStringList>
+
+#include "gchighlighter.h"
+#include "psioptions.h"
+
+class TestGCHighlighter: public QObject
+{
+	Q_OBJECT
+private:
+	GCHighlighter *hl;
+
+	void setWords(const QStringList &words)
+	{
+		PsiOptions::instance()->setOption("options.ui.muc.highlight-words", words);
+	}
+
+private slots:
+	void initTestCase()
+	{
+		PsiOptions::instance()->setOption("options.ui.muc.use-highlighting", true);
+		setWords(QStringList());
+		hl = new GCHighlighter();
+		hl->setNick("Joe");
+	}
+
+	void cleanupTestCase()
+	{
+		delete hl;
+	}
+
+	void testNick()
+	{
+		QCOMPARE(hl->match("hi Joe"), GCHighlighter::Matches(GCHighlighter::MentionsNick));
+		QCOMPARE(hl->match("Joe: hi"), GCHighlighter::Matches(GCHighlighter::MentionsNick));
+		// own nick is case sensitive
+		QCOMPARE(hl->match("hi joe"), GCHighlighter::Matches(GCHighlighter::NoMatch));
+		QCOMPARE(hl->match(""), GCHighlighter::Matches(GCHighlighter::NoMatch));
+	}
+
+	void testWords()
+	{
+		setWords(QStringList() << "he" << "she" << "hers" << "");
+		QCOMPARE(hl->match("USHERS"), GCHighlighter::Matches(GCHighlighter::Highlighted));
+		QCOMPARE(hl->match("what she said"), GCHighlighter::Matches(GCHighlighter::Highlighted));
+		QCOMPARE(hl->match("nothing"), GCHighlighter::Matches(GCHighlighter::NoMatch));
+		QCOMPARE(hl->match("she told Joe"), GCHighlighter::MentionsNick | GCHighlighter::Highlighted);
+	}
+
+	void testOverlappingNick()
+	{
+		// a case insensitive word sharing a prefix with the nick
+		setWords(QStringList() << "joey");
+		QCOMPARE(hl->match("JOEY"), GCHighlighter::Matches(GCHighlighter::Highlighted));
+		QCOMPARE(hl->match("Joey"), GCHighlighter::MentionsNick | GCHighlighter::Highlighted);
+		QCOMPARE(hl->match("joJoe"), GCHighlighter::Matches(GCHighlighter::MentionsNick));
+	}
+
+	void testHighlightingDisabled()
+	{
+		setWords(QStringList() << "word");
+		PsiOptions::instance()->setOption("options.ui.muc.use-highlighting", false);
+		QVERIFY(!hl->highlightingEnabled());
+		QCOMPARE(hl->match("word Joe"), GCHighlighter::Matches(GCHighlighter::MentionsNick));
+		PsiOptions::instance()->setOption("options.ui.muc.use-highlighting", true);
+		QCOMPARE(hl->match("word Joe"), GCHighlighter::MentionsNick | GCHighlighter::Highlighted);
+	}
+
+	void testNickColor()
+	{
+		PsiOptions::instance()->setOption("options.ui.muc.use-nick-coloring", true);
+		PsiOptions::instance()->setOption("options.ui.look.colors.muc.nick-colors",
+		                                  QStringList() << "#111111" << "#222222" << "#333333");
+		QCOMPARE(hl->nickColor(-1), QString("#333333"));
+		QCOMPARE(hl->nickColor(0), QString("#111111"));
+		QCOMPARE(hl->nickColor(3), QString("#222222"));
+		PsiOptions::instance()->setOption("options.ui.muc.use-nick-coloring", false);
+		QCOMPARE(hl->nickColor(0), QString("#000000"));
+	}
+};
+
+QTEST_MAIN(TestGCHighlighter)
+#include "testgchighlighter.moc"
@@ -0,0 +1,4 @@
+TARGET = testgchighlighter
+SOURCES += testgchighlighter.cpp
+
+include(../half_of_psi.pri)
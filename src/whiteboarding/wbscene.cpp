@@ -20,16 +20,35 @@
 
 #include "wbscene.h"
 
+// The time (in ms) without further manipulation after which queued transformations
+// are sent even though the mouse hasn't been released
+enum {TRANSFORMATIONIDLETIME = 2000};
+
 WbScene::WbScene(SxeSession* session, QObject * parent) : QGraphicsScene(parent) {
 	session_ = session;
+
+	transformationTimer_.setSingleShot(true);
+	transformationTimer_.setInterval(TRANSFORMATIONIDLETIME);
+	connect(&transformationTimer_, SIGNAL(timeout()), SLOT(regenerateTransformations()));
 };
 
 void WbScene::queueTransformationRegeneration(WbItem* item) {
-	if(item && !pendingTranformations_.contains(item))
-		pendingTranformations_.append(QPointer<WbItem>(item));
+	if(item) {
+		QPointer<WbItem> &queued = pendingTranformationIndex_[item];
+		if(!queued) {
+			queued = item;
+			pendingTranformations_.append(queued);
+		}
+	}
+
+	// normally the mouse release flushes
+	if(!pendingTranformations_.isEmpty())
+		transformationTimer_.start();
 }
 
 void WbScene::regenerateTransformations() {
+	transformationTimer_.stop();
+
 	foreach(QPointer<WbItem> item, pendingTranformations_) {
 		if(item) {
 			// qDebug() << QString("Regenerating %1 transform.").arg((unsigned int) &(*item)).toAscii();
@@ -37,9 +56,22 @@ void WbScene::regenerateTransformations() {
 		}
 	}
 	pendingTranformations_.clear();
+	pendingTranformationIndex_.clear();
+
+	// all the regenerated transformations go out in a single <sxe/>
 	session_->flush();
 }
 
+QList<WbItem*> WbScene::wbItems(const QRectF &rect) const {
+	QList<WbItem*> result;
+	foreach(QGraphicsItem* item, items(rect, Qt::IntersectsItemShape)) {
+		WbItem* wbitem = dynamic_cast<WbItem*>(item);
+		if(wbitem)
+			result.append(wbitem);
+	}
+	return result;
+}
+
 QPointF WbScene::selectionCenter() const {
 	QList<QGraphicsItem*> items = selectedItems();
 
@@ -143,8 +175,11 @@ void WbScene::bring(int n, bool toExtremum) {
 	if(n == 0)
 		 return;
 
+	QList<QGraphicsItem*> selected = selectedItems();
+	QSet<QGraphicsItem*> selectedSet = selected.toSet();
+
 	// bring each selected item
-	foreach(QGraphicsItem* selecteditem, selectedItems()) {
+	foreach(QGraphicsItem* selecteditem, selected) {
 
 		if (!(selecteditem->parentItem() && selecteditem->parentItem()->isSelected())) {
 
@@ -158,7 +193,7 @@ void WbScene::bring(int n, bool toExtremum) {
 				// remove other selected items from the list colliding
 				int i = 0;
 				while(i < colliding.size()) {
-					if(selectedItems().contains(colliding[i])) {
+					if(selectedSet.contains(colliding[i])) {
 						colliding.removeAt(i);
 					} else if(colliding[i]->zValue() < selecteditem->zValue()) {
 						break;
@@ -20,6 +20,8 @@
 #ifndef WBSCENE_H
 #define WBSCENE_H
 #include <QPointer>
+#include <QHash>
+#include <QTimer>
 #include "wbitem.h"
 
 /*! \brief The scene class for whiteboard items.
@@ -43,14 +45,21 @@ public:
 	 */
 	WbScene(SxeSession* session, QObject * parent = 0);
 
-	/*! \brief Appends the item to a list of items whose "transform" attribute is to be regenerated.*/
+	/*! \brief Appends the item to a list of items whose "transform" attribute is to be regenerated.
+	 *  The queue is flushed when the mouse is released, or if the manipulation stalls for a while,
+	 *  so that a drag results in a single edit.
+	 */
 	void queueTransformationRegeneration(WbItem* item);
-	/*! \brief Regenerate the SVG transformation matrices for items queued by queueTransformationRegeneration(WbItem* item) since last regeneration.*/
-	void regenerateTransformations();
+	/*! \brief Returns the whiteboard items whose shape intersects \a rect.
+	 *  Uses the scene's BSP index so the cost doesn't depend on the total number of items.
+	 */
+	QList<WbItem*> wbItems(const QRectF &rect) const;
 	/*! \brief Returns the coordinates of the center of all selected items. */
     QPointF selectionCenter() const;
 
 public slots:
+	/*! \brief Regenerate the SVG transformation matrices for items queued by queueTransformationRegeneration(WbItem* item) since last regeneration.*/
+	void regenerateTransformations();
     /*! \brief Brings the selected items \a n levels forward. */
     void bringForward(int n = 1);
     /*! \brief Brings the item to the top. */
@@ -73,6 +82,12 @@ private:
 
     SxeSession* session_;
     QList< QPointer<WbItem> > pendingTranformations_;
+    /*! \brief The same items as pendingTranformations_ for constant time lookups.
+     *  The guarded pointers tell a queued item from a new one at the address of a deleted one.
+     */
+    QHash<WbItem*, QPointer<WbItem> > pendingTranformationIndex_;
+    /*! \brief Flushes the pending transformations if no mouse release comes.*/
+    QTimer transformationTimer_;
     
     QPointF selectionCenter_;
 };
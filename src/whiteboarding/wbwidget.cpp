@@ -286,15 +286,10 @@ void WbWidget::mouseMoveEvent(QMouseEvent * event) {
 		 if(event->buttons() != Qt::MouseButtons(Qt::LeftButton))
 			 return;
 		 // Erase all items that appear in a 2*strokeWidth_ square with center at the event position
+		 // Query the scene index directly rather than adding a temporary item to collide with
 		 QPointF p = mapToScene(mapFromGlobal(event->globalPos()));
-		 QGraphicsRectItem* eraseRect = scene_->addRect(QRectF(p.x() - strokeWidth_, p.y() - strokeWidth_, 2 * strokeWidth_, 2 * strokeWidth_));
-		 foreach(QGraphicsItem * item, eraseRect->collidingItems()) {
-			WbItem* wbitem = dynamic_cast<WbItem*>(item);
-			if(wbitem)
-				session_->removeNode(wbitem->node());
-		 }
-		 delete eraseRect;
-		 eraseRect = 0;
+		 foreach(WbItem* wbitem, scene_->wbItems(QRectF(p.x() - strokeWidth_, p.y() - strokeWidth_, 2 * strokeWidth_, 2 * strokeWidth_)))
+			session_->removeNode(wbitem->node());
 
 		 event->ignore();
 		 return;
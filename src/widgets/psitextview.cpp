@@ -26,6 +26,8 @@
 #include <QTextDocumentFragment>
 #include <QTextFragment>
 #include <QMimeData>
+#include <QTextBlock>
+#include <QTimer>
 
 #include "urlobject.h"
 #include "psirichtext.h"
@@ -34,6 +36,10 @@
 // PsiTextView::Private
 //----------------------------------------------------------------------------
 
+// block format property set on the first paragraph of each message, holding
+// the time passed to setTimestamp()
+enum { TimestampProperty = QTextFormat::UserProperty + 1 };
+
 //! \if _hide_doc_
 class PsiTextView::Private : public QObject
 {
@@ -45,17 +51,76 @@ public:
 	{
 		anchorOnMousePress = QString();
 		hadSelectionOnMousePress = false;
+		scrollbackLimit = 0;
+		droppedBlocks = 0;
+		messageStarting = false;
+		prependDoc = 0;
+		liveMessageStarting = false;
+
+		renderTimer = new QTimer(this);
+		renderTimer->setSingleShot(true);
+		renderTimer->setInterval(RenderInterval);
 	}
 
+	// text passed to queueText() is rendered in batches at most this
+	// often (in msecs)
+	enum { RenderInterval = 16 };
+
 	QString anchorOnMousePress;
 	bool hadSelectionOnMousePress;
 
+	int scrollbackLimit;
+	int droppedBlocks;
+	QDateTime timestamp;
+	bool messageStarting;
+	QTextDocument *prependDoc;
+	// message state of the live log while a page is being prepended
+	QDateTime liveTimestamp;
+	bool liveMessageStarting;
+
+	QStringList queuedText;
+	QTimer *renderTimer;
+
+	void appendMessageText(QTextDocument *doc, QTextCursor &cursor, const QString &text);
+
 	QString fragmentToPlainText(const QTextFragment &fragment);
 	QString blockToPlainText(const QTextBlock &block);
 	QString documentFragmentToPlainText(const QTextDocument &doc, QTextFrame::Iterator frameIt);
 };
 //!endif
 
+/**
+ * Appends \a text like PsiRichText::appendText() does. Only the first
+ * paragraph of a message is tagged with TimestampProperty, so the tags
+ * mark where messages begin: without timestamps each text is a message
+ * of its own, otherwise a message is everything appended between two
+ * setTimestamp() calls.
+ */
+void PsiTextView::Private::appendMessageText(QTextDocument *doc, QTextCursor &cursor, const QString &text)
+{
+	// PsiRichText::appendText() reuses the last paragraph only if it's empty
+	QTextBlock last = doc->lastBlock();
+	int first = last.length() > 1 ? last.blockNumber() + 1 : last.blockNumber();
+
+	PsiRichText::appendText(doc, cursor, text);
+
+	// new paragraphs inherit the format of the previous one, tag included
+	bool start = messageStarting || !timestamp.isValid();
+	messageStarting = false;
+	QTextCursor format(doc);
+	for (QTextBlock block = doc->findBlockByNumber(first); block.isValid(); block = block.next()) {
+		QTextBlockFormat blockFormat = block.blockFormat();
+		if (start && block.blockNumber() == first)
+			blockFormat.setProperty(TimestampProperty, timestamp);
+		else if (blockFormat.hasProperty(TimestampProperty))
+			blockFormat.clearProperty(TimestampProperty);
+		else
+			continue;
+		format.setPosition(block.position());
+		format.setBlockFormat(blockFormat);
+	}
+}
+
 //----------------------------------------------------------------------------
 // PsiTextView
 //----------------------------------------------------------------------------
@@ -77,6 +142,9 @@ PsiTextView::PsiTextView(QWidget *parent)
 	PsiRichText::install(document());
 
 	viewport()->setMouseTracking(true); // we want to get all mouseMoveEvents
+
+	connect(verticalScrollBar(), SIGNAL(valueChanged(int)), SLOT(scrollBarValueChanged(int)));
+	connect(d->renderTimer, SIGNAL(timeout()), SLOT(flushQueuedText()));
 }
 
 /**
@@ -111,13 +179,270 @@ void PsiTextView::scrollToTop()
  */
 void PsiTextView::appendText(const QString &text)
 {
+	// anything still queued goes first
+	d->queuedText += text;
+	flushQueuedText();
+}
+
+/**
+ * Like appendText(), but the text is only rendered on the next flush,
+ * together with everything else queued until then. Use it for bursts of
+ * messages, like the history replayed when joining a groupchat, so the
+ * document is laid out and scrolled once per batch instead of once per
+ * message.
+ */
+void PsiTextView::queueText(const QString &text)
+{
+	d->queuedText += text;
+	if (!d->renderTimer->isActive())
+		d->renderTimer->start();
+}
+
+/**
+ * Clears the log, including text queued but not rendered yet.
+ */
+void PsiTextView::clear()
+{
+	d->renderTimer->stop();
+	d->queuedText.clear();
+	d->droppedBlocks = 0;
+	QTextEdit::clear();
+}
+
+/**
+ * Renders all text passed to queueText() so far. It is called
+ * automatically after a short delay, but needs to be called before
+ * touching the end of the document directly.
+ */
+void PsiTextView::flushQueuedText()
+{
+	d->renderTimer->stop();
+	if (d->queuedText.isEmpty())
+		return;
+
+	QStringList texts = d->queuedText;
+	d->queuedText.clear();
+	appendTexts(texts);
+}
+
+/**
+ * Appends a batch of paragraphs, see appendText(). Subclasses reimplement
+ * it to control scrolling.
+ */
+void PsiTextView::appendTexts(const QStringList &texts)
+{
+	int dropped = insertText(texts);
+	if (dropped)
+		verticalScrollBar()->setValue(verticalScrollBar()->value() - dropped);
+}
+
+/**
+ * Does the actual work of appendTexts(). Between beginPrepend() and
+ * endPrepend() the text is collected for insertion at the top instead.
+ * \return height in pixels of the blocks dropped by trimScrollback()
+ */
+int PsiTextView::insertText(const QStringList &texts)
+{
+	if (d->prependDoc) {
+		QTextCursor cursor(d->prependDoc);
+		foreach(const QString &text, texts)
+			d->appendMessageText(d->prependDoc, cursor, text);
+		return 0;
+	}
+
+	bool following = atBottom();
 	QTextCursor cursor = textCursor();
 	PsiRichText::Selection selection = PsiRichText::saveSelection(this, cursor);
 
-	PsiRichText::appendText(document(), cursor, text);
+	// a single edit block, so the document is laid out once per batch
+	QTextCursor edit(document());
+	edit.beginEditBlock();
+	foreach(const QString &text, texts)
+		d->appendMessageText(document(), cursor, text);
+	edit.endEditBlock();
 
 	PsiRichText::restoreSelection(this, cursor, selection);
 	setTextCursor(cursor);
+
+	return trimScrollback(following);
+}
+
+/**
+ * Limits the log to \a blocks paragraphs, 0 means no limit. Once there
+ * are more, the oldest ones get dropped on append. Nothing is dropped
+ * while the view isn't scrolled to the bottom, so neither text the user
+ * is reading nor history paged back in disappears under them; the log
+ * is cut back on the first append after they return to the bottom.
+ */
+void PsiTextView::setScrollbackLimit(int blocks)
+{
+	d->scrollbackLimit = qMax(0, blocks);
+}
+
+int PsiTextView::scrollbackLimit() const
+{
+	return d->scrollbackLimit;
+}
+
+/**
+ * Returns number of paragraphs dropped because of the scrollback limit
+ * and not yet replaced by text inserted with beginPrepend().
+ */
+int PsiTextView::droppedBlocks() const
+{
+	return d->droppedBlocks;
+}
+
+/**
+ * Drops the oldest paragraphs above the scrollback limit. \a following
+ * tells whether the view is kept scrolled to the bottom.
+ * \return height in pixels of the dropped paragraphs
+ */
+int PsiTextView::trimScrollback(bool following)
+{
+	int limit = d->scrollbackLimit;
+	int count = document()->blockCount();
+	if (limit <= 0 || count <= limit || !following)
+		return 0;
+
+	// never cut a message in half
+	QTextBlock firstKept = document()->findBlockByNumber(count - limit);
+	while (firstKept.isValid() && !firstKept.blockFormat().hasProperty(TimestampProperty))
+		firstKept = firstKept.next();
+	if (!firstKept.isValid())
+		return 0;
+
+	int excess = firstKept.blockNumber();
+	QAbstractTextDocumentLayout *layout = document()->documentLayout();
+	int height = qRound(layout->blockBoundingRect(firstKept).top() -
+	                    layout->blockBoundingRect(document()->begin()).top());
+
+	QTextCursor cursor(document());
+	cursor.setPosition(firstKept.position(), QTextCursor::KeepAnchor);
+	cursor.removeSelectedText();
+
+	d->droppedBlocks += excess;
+	emit scrollbackTrimmed();
+	return height;
+}
+
+/**
+ * Starts a new message sent at \a time. Text appended from now on up to
+ * the next call belongs to it, see oldestTimestamp().
+ */
+void PsiTextView::setTimestamp(const QDateTime &time)
+{
+	// queued text belongs to the previous message
+	flushQueuedText();
+	d->timestamp = time;
+	d->messageStarting = true;
+}
+
+/**
+ * Returns the time of the topmost message started by setTimestamp(), or
+ * an invalid QDateTime if there's none.
+ */
+QDateTime PsiTextView::oldestTimestamp() const
+{
+	for (QTextBlock block = document()->begin(); block.isValid(); block = block.next()) {
+		QDateTime time = block.blockFormat().property(TimestampProperty).toDateTime();
+		if (time.isValid())
+			return time;
+	}
+	return QDateTime();
+}
+
+/**
+ * Returns how many of the topmost messages were sent within the same
+ * second as oldestTimestamp(), which is as precise as history gets.
+ */
+int PsiTextView::oldestTimestampCount() const
+{
+	int count = 0;
+	uint oldest = 0;
+	for (QTextBlock block = document()->begin(); block.isValid(); block = block.next()) {
+		QDateTime time = block.blockFormat().property(TimestampProperty).toDateTime();
+		if (!time.isValid())
+			continue;
+		if (count && time.toTime_t() != oldest)
+			break;
+		oldest = time.toTime_t();
+		++count;
+	}
+	return count;
+}
+
+/**
+ * Text passed to appendText() after this call is collected and inserted
+ * above the current contents by endPrepend(), which is used for paging
+ * older messages back in. Messages started by setTimestamp() in between
+ * belong to the prepended text only.
+ */
+void PsiTextView::beginPrepend()
+{
+	if (d->prependDoc)
+		return;
+	flushQueuedText();
+	d->liveTimestamp = d->timestamp;
+	d->liveMessageStarting = d->messageStarting;
+	d->prependDoc = new QTextDocument(this);
+	d->prependDoc->setUndoRedoEnabled(false);
+	PsiRichText::install(d->prependDoc);
+}
+
+/**
+ * Inserts the text collected since beginPrepend() at the top, keeping the
+ * visible part of the log where it was.
+ */
+void PsiTextView::endPrepend()
+{
+	QTextDocument *doc = d->prependDoc;
+	if (!doc)
+		return;
+	d->prependDoc = 0;
+	d->timestamp = d->liveTimestamp;
+	d->messageStarting = d->liveMessageStarting;
+
+	if (!doc->isEmpty()) {
+		int value = verticalScrollBar()->value();
+		int blocks = doc->blockCount();
+		QTextBlockFormat firstFormat = document()->begin().blockFormat();
+
+		QTextCursor cursor(document());
+		cursor.beginEditBlock();
+		cursor.insertBlock();
+		cursor.movePosition(QTextCursor::Start);
+		cursor.insertFragment(QTextDocumentFragment(doc));
+
+		// the fragment and the split don't reliably carry the message tags
+		QTextBlock source = doc->begin();
+		QTextBlock target = document()->begin();
+		for (; source.isValid(); source = source.next(), target = target.next()) {
+			cursor.setPosition(target.position());
+			cursor.setBlockFormat(source.blockFormat());
+		}
+		cursor.setPosition(target.position());
+		cursor.setBlockFormat(firstFormat);
+		cursor.endEditBlock();
+
+		d->droppedBlocks = qMax(0, d->droppedBlocks - blocks);
+
+		QAbstractTextDocumentLayout *layout = document()->documentLayout();
+		int height = qRound(layout->blockBoundingRect(document()->findBlockByNumber(blocks)).top() -
+		                    layout->blockBoundingRect(document()->begin()).top());
+		verticalScrollBar()->setValue(value + height);
+	}
+
+	delete doc;
+}
+
+void PsiTextView::scrollBarValueChanged(int value)
+{
+	if (!d->prependDoc && value == verticalScrollBar()->minimum() &&
+	    verticalScrollBar()->maximum() > verticalScrollBar()->minimum())
+	{
+		emit topReached();
+	}
 }
 
 QString PsiTextView::getTextHelper(bool html) const
@@ -22,6 +22,8 @@
 #define PSITEXTVIEW
 
 #include <QTextEdit>
+#include <QDateTime>
+#include <QStringList>
 
 class QMimeData;
 class QTextCursor;
@@ -35,15 +37,37 @@ public:
 	bool atBottom();
 
 	virtual void appendText(const QString &text);	
+	void queueText(const QString &text);
 
 	QString getHtml() const;
 	QString getPlainText() const;
+
+	void setScrollbackLimit(int blocks);
+	int scrollbackLimit() const;
+	int droppedBlocks() const;
+
+	void setTimestamp(const QDateTime &time);
+	QDateTime oldestTimestamp() const;
+	int oldestTimestampCount() const;
+
+	void beginPrepend();
+	void endPrepend();
 	
 public slots:
+	void clear();
 	void scrollToBottom();
 	void scrollToTop();
+	void flushQueuedText();
+
+signals:
+	void topReached();
+	void scrollbackTrimmed();
 	
 protected:
+	virtual void appendTexts(const QStringList &texts);
+	int insertText(const QStringList &texts);
+	int trimScrollback(bool following);
+
 	// make these functions unusable, because they modify
 	// document structure and we can't override them to
 	// handle Icons correctly
@@ -66,6 +90,9 @@ protected:
 	QString getTextHelper(bool html) const;
 
 	class Private;
+private slots:
+	void scrollBarValueChanged(int value);
+
 private:
 	Private *d;
 };